@@ -0,0 +1,308 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "bit_utils.hpp"
+
+// Simpler bounded queues to benchmark the disruptor against. Each mirrors the
+// disruptor's setup calls so that benchmarks can be written once for all of
+// them: create_writer and create_reader hand back the queue itself, and every
+// reader takes items from the others rather than seeing every item. write and
+// read block, spinning or sleeping as the design does
+namespace dq::bench
+{
+
+// A std::deque behind a std::mutex, retrying with a yield when full or empty
+template <typename T, std::size_t CAPACITY>
+class mutex_deque_queue
+{
+ public:
+  mutex_deque_queue& create_writer() noexcept { return *this; }
+  mutex_deque_queue& create_reader() noexcept { return *this; }
+  void start() noexcept {}
+
+  void write(T value);
+  T read();
+
+ private:
+  std::mutex _mutex;
+  std::deque<T> _items{};
+};
+
+template <typename T, std::size_t CAPACITY>
+void mutex_deque_queue<T, CAPACITY>::write(T value)
+{
+  while (true)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_items.size() < CAPACITY)
+      {
+        _items.push_back(std::move(value));
+        return;
+      }
+    }
+
+    std::this_thread::yield();
+  }
+}
+
+template <typename T, std::size_t CAPACITY>
+T mutex_deque_queue<T, CAPACITY>::read()
+{
+  while (true)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_items.empty())
+      {
+        T value = std::move(_items.front());
+        _items.pop_front();
+        return value;
+      }
+    }
+
+    std::this_thread::yield();
+  }
+}
+
+// A std::deque behind a std::mutex whose writers and readers sleep on
+// condition variables until there is space or data
+template <typename T, std::size_t CAPACITY>
+class condvar_queue
+{
+ public:
+  condvar_queue& create_writer() noexcept { return *this; }
+  condvar_queue& create_reader() noexcept { return *this; }
+  void start() noexcept {}
+
+  void write(T value);
+  T read();
+
+ private:
+  std::mutex _mutex;
+  std::condition_variable _not_empty;
+  std::condition_variable _not_full;
+  std::deque<T> _items{};
+};
+
+template <typename T, std::size_t CAPACITY>
+void condvar_queue<T, CAPACITY>::write(T value)
+{
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _not_full.wait(lock, [this]() { return _items.size() < CAPACITY; });
+    _items.push_back(std::move(value));
+  }
+
+  _not_empty.notify_one();
+}
+
+template <typename T, std::size_t CAPACITY>
+T condvar_queue<T, CAPACITY>::read()
+{
+  T value;
+
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _not_empty.wait(lock, [this]() { return !_items.empty(); });
+    value = std::move(_items.front());
+    _items.pop_front();
+  }
+
+  _not_full.notify_one();
+  return value;
+}
+
+// Dmitry Vyukov's bounded MPMC ring. Each cell's sequence says whether it is
+// ready for the writer or the reader of a given lap, and writers and readers
+// claim positions with a compare-exchange on their own shared cursor
+template <typename T, std::size_t CAPACITY>
+class vyukov_mpmc_queue
+{
+  static_assert(internal::is_power_of_two(CAPACITY),
+                "Queue capacity must be a power of two");
+
+ public:
+  vyukov_mpmc_queue() noexcept;
+
+  vyukov_mpmc_queue& create_writer() noexcept { return *this; }
+  vyukov_mpmc_queue& create_reader() noexcept { return *this; }
+  void start() noexcept {}
+
+  bool try_write(T& value);
+  bool try_read(T& value);
+
+  void write(T value);
+  T read();
+
+ private:
+  static constexpr std::size_t MASK = CAPACITY - 1;
+
+  struct alignas(64) cell
+  {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+
+  std::array<cell, CAPACITY> _cells;
+  alignas(64) std::atomic<std::size_t> _enqueue_position{0};
+  alignas(64) std::atomic<std::size_t> _dequeue_position{0};
+};
+
+template <typename T, std::size_t CAPACITY>
+vyukov_mpmc_queue<T, CAPACITY>::vyukov_mpmc_queue() noexcept
+{
+  for (std::size_t i = 0; i < CAPACITY; ++i)
+  {
+    _cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+template <typename T, std::size_t CAPACITY>
+bool vyukov_mpmc_queue<T, CAPACITY>::try_write(T& value)
+{
+  std::size_t position = _enqueue_position.load(std::memory_order_relaxed);
+
+  while (true)
+  {
+    cell& target = _cells[position & MASK];
+    const std::size_t sequence =
+        target.sequence.load(std::memory_order_acquire);
+    const auto difference = static_cast<std::intptr_t>(sequence) -
+                            static_cast<std::intptr_t>(position);
+
+    if (difference == 0)
+    {
+      if (_enqueue_position.compare_exchange_weak(position, position + 1,
+                                                  std::memory_order_relaxed))
+      {
+        target.value = std::move(value);
+        target.sequence.store(position + 1, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (difference < 0)
+    {
+      return false;
+    }
+    else
+    {
+      position = _enqueue_position.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T, std::size_t CAPACITY>
+bool vyukov_mpmc_queue<T, CAPACITY>::try_read(T& value)
+{
+  std::size_t position = _dequeue_position.load(std::memory_order_relaxed);
+
+  while (true)
+  {
+    cell& source = _cells[position & MASK];
+    const std::size_t sequence =
+        source.sequence.load(std::memory_order_acquire);
+    const auto difference = static_cast<std::intptr_t>(sequence) -
+                            static_cast<std::intptr_t>(position + 1);
+
+    if (difference == 0)
+    {
+      if (_dequeue_position.compare_exchange_weak(position, position + 1,
+                                                  std::memory_order_relaxed))
+      {
+        value = std::move(source.value);
+        source.sequence.store(position + CAPACITY, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (difference < 0)
+    {
+      return false;
+    }
+    else
+    {
+      position = _dequeue_position.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T, std::size_t CAPACITY>
+void vyukov_mpmc_queue<T, CAPACITY>::write(T value)
+{
+  while (!try_write(value))
+  {
+  }
+}
+
+template <typename T, std::size_t CAPACITY>
+T vyukov_mpmc_queue<T, CAPACITY>::read()
+{
+  T value;
+  while (!try_read(value))
+  {
+  }
+  return value;
+}
+
+// Lamport's single-producer single-consumer ring: the writer owns the tail,
+// the reader the head, and each checks the other's index on every operation.
+// One writer and one reader only
+template <typename T, std::size_t CAPACITY>
+class lamport_spsc_queue
+{
+  static_assert(internal::is_power_of_two(CAPACITY),
+                "Queue capacity must be a power of two");
+
+ public:
+  lamport_spsc_queue& create_writer() noexcept { return *this; }
+  lamport_spsc_queue& create_reader() noexcept { return *this; }
+  void start() noexcept {}
+
+  void write(T value);
+  T read();
+
+ private:
+  static constexpr std::size_t MASK = CAPACITY - 1;
+
+  std::array<T, CAPACITY> _buffer{};
+  alignas(64) std::atomic<std::size_t> _head{0};
+  alignas(64) std::atomic<std::size_t> _tail{0};
+};
+
+template <typename T, std::size_t CAPACITY>
+void lamport_spsc_queue<T, CAPACITY>::write(T value)
+{
+  const std::size_t tail = _tail.load(std::memory_order_relaxed);
+
+  while (tail - _head.load(std::memory_order_acquire) == CAPACITY)
+  {
+  }
+
+  _buffer[tail & MASK] = std::move(value);
+  _tail.store(tail + 1, std::memory_order_release);
+}
+
+template <typename T, std::size_t CAPACITY>
+T lamport_spsc_queue<T, CAPACITY>::read()
+{
+  const std::size_t head = _head.load(std::memory_order_relaxed);
+
+  while (_tail.load(std::memory_order_acquire) == head)
+  {
+  }
+
+  T value = std::move(_buffer[head & MASK]);
+  _head.store(head + 1, std::memory_order_release);
+  return value;
+}
+
+}  // namespace dq::bench
@@ -0,0 +1,440 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "latency_histogram.hpp"
+#include "thread_placement.hpp"
+#include "tsc_clock.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dq::bench
+{
+
+// Benchmarks place their threads by
+// DQ_BENCH_PLACEMENT=unpinned|shared_l2|shared_l3|separate_l3, shared_l3 by
+// default. DQ_BENCH_REALTIME=1 also moves them to SCHED_FIFO, which can
+// starve the rest of the machine while they spin. Each plan is reported once
+// on stderr
+inline bool benchmark_realtime()
+{
+  const char* const realtime = std::getenv("DQ_BENCH_REALTIME");
+  return realtime != nullptr && realtime[0] == '1';
+}
+
+inline const dq::placement_plan& benchmark_placement(const std::size_t threads)
+{
+  static std::mutex plans_mutex;
+  static std::map<std::size_t, dq::placement_plan> plans;
+
+  std::lock_guard<std::mutex> lock(plans_mutex);
+  const auto found = plans.find(threads);
+
+  if (found != plans.end())
+  {
+    return found->second;
+  }
+
+  const char* const requested = std::getenv("DQ_BENCH_PLACEMENT");
+  const dq::placement_policy policy =
+      dq::parse_placement_policy(requested != nullptr ? requested : "")
+          .value_or(dq::placement_policy::shared_l3);
+
+  const dq::cpu_topology topology = dq::cpu_topology::detect();
+  const dq::placement_plan& plan =
+      plans.emplace(threads, dq::plan_placement(topology, threads, policy))
+          .first->second;
+  std::fprintf(stderr, "%s\n", plan.to_string(topology).c_str());
+
+  return plan;
+}
+
+// Places a thread the benchmark started as role index of threads
+inline void place_benchmark_thread(const std::size_t index,
+                                   const std::size_t threads)
+{
+  dq::place_current_thread(benchmark_placement(threads).cpus[index],
+                           benchmark_realtime());
+}
+
+// Places the benchmark's own thread for the duration of the benchmark and
+// labels it with the placement achieved. The thread is restored afterwards so
+// that later benchmarks, whose threads inherit its affinity, are not confined
+// to one CPU
+inline dq::scoped_thread_placement place_benchmark_thread(
+    const std::size_t index, const std::size_t threads,
+    benchmark::State& state)
+{
+  state.SetLabel(dq::to_string(benchmark_placement(threads).achieved));
+  return dq::scoped_thread_placement(benchmark_placement(threads).cpus[index],
+                                     benchmark_realtime());
+}
+
+// Threads that live for a whole benchmark and run body once per round. The
+// benchmark's thread brackets each iteration with begin_round and end_round,
+// doing its own share of the work in between, so thread creation stays out of
+// the measurement. Worker i takes role first_role + i of threads, or is left
+// to the scheduler when constructed without roles
+class persistent_workers
+{
+ public:
+  using body_type = std::function<void(std::size_t worker)>;
+
+  persistent_workers(std::size_t workers, std::size_t first_role,
+                     std::size_t threads, body_type body);
+  persistent_workers(std::size_t workers, body_type body);
+  ~persistent_workers();
+
+  persistent_workers(const persistent_workers&) = delete;
+  persistent_workers& operator=(const persistent_workers&) = delete;
+
+  void begin_round();
+  void end_round();
+
+ private:
+  const body_type _body;
+  std::barrier<> _round_start;
+  std::barrier<> _round_end;
+  std::atomic<bool> _stop{false};
+  std::vector<std::thread> _threads{};
+};
+
+inline persistent_workers::persistent_workers(const std::size_t workers,
+                                              const std::size_t first_role,
+                                              const std::size_t threads,
+                                              body_type body)
+    : _body{std::move(body)},
+      _round_start{static_cast<std::ptrdiff_t>(workers + 1)},
+      _round_end{static_cast<std::ptrdiff_t>(workers + 1)}
+{
+  _threads.reserve(workers);
+
+  for (std::size_t i = 0; i < workers; ++i)
+  {
+    _threads.emplace_back([this, i, first_role, threads]() {
+      if (threads != 0)
+      {
+        place_benchmark_thread(first_role + i, threads);
+      }
+
+      while (true)
+      {
+        _round_start.arrive_and_wait();
+        if (_stop.load(std::memory_order_acquire))
+        {
+          return;
+        }
+
+        _body(i);
+        _round_end.arrive_and_wait();
+      }
+    });
+  }
+}
+
+inline persistent_workers::persistent_workers(const std::size_t workers,
+                                              body_type body)
+    : persistent_workers(workers, 0, 0, std::move(body))
+{
+}
+
+inline persistent_workers::~persistent_workers()
+{
+  _stop.store(true, std::memory_order_release);
+  _round_start.arrive_and_wait();
+
+  for (std::thread& thread : _threads)
+  {
+    thread.join();
+  }
+}
+
+inline void persistent_workers::begin_round()
+{
+  _round_start.arrive_and_wait();
+}
+
+inline void persistent_workers::end_round()
+{
+  _round_end.arrive_and_wait();
+}
+
+// Hardware counters of the calling thread and of threads it starts while they
+// are open, read through perf_event_open. Counters the kernel, the CPU or
+// perf_event_paranoid do not allow are skipped, and each is reported missing
+// once on stderr. Counts are scaled when the kernel multiplexes them
+class perf_counters
+{
+ public:
+  perf_counters();
+  ~perf_counters();
+
+  perf_counters(const perf_counters&) = delete;
+  perf_counters& operator=(const perf_counters&) = delete;
+
+  void start() noexcept;
+  void stop() noexcept;
+
+  // Adds <name>_per_item counters for every counter that opened, plus ipc
+  void report(benchmark::State& state, double items) const;
+
+ private:
+  struct event
+  {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+  };
+
+  static std::vector<event> events();
+  static double read_scaled(int fd) noexcept;
+
+  std::vector<std::pair<const char*, int>> _counters{};
+};
+
+inline auto perf_counters::events() -> std::vector<event>
+{
+  std::vector<event> supported;
+
+#ifdef __linux__
+  const auto cache_read_miss = [](const uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  };
+
+  supported = {
+      {"hw_cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {"l1d_misses", PERF_TYPE_HW_CACHE,
+       cache_read_miss(PERF_COUNT_HW_CACHE_L1D)},
+      {"llc_misses", PERF_TYPE_HW_CACHE,
+       cache_read_miss(PERF_COUNT_HW_CACHE_LL)},
+      {"dtlb_misses", PERF_TYPE_HW_CACHE,
+       cache_read_miss(PERF_COUNT_HW_CACHE_DTLB)},
+  };
+
+#if defined(__x86_64__) || defined(__i386__)
+  // MACHINE_CLEARS.COUNT has no generic event and this encoding is Intel's
+  if (__builtin_cpu_is("intel"))
+  {
+    supported.push_back({"machine_clears", PERF_TYPE_RAW, 0x01c3});
+  }
+#endif
+#endif
+
+  return supported;
+}
+
+inline perf_counters::perf_counters()
+{
+#ifdef __linux__
+  static std::mutex reported_mutex;
+  static std::vector<std::string> reported;
+
+  for (const event& counter : events())
+  {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = counter.type;
+    attr.config = counter.config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    const int fd =
+        static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+
+    if (fd >= 0)
+    {
+      _counters.emplace_back(counter.name, fd);
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock(reported_mutex);
+    if (std::find(reported.begin(), reported.end(), counter.name) ==
+        reported.end())
+    {
+      reported.emplace_back(counter.name);
+      std::fprintf(stderr, "perf counter %s unavailable: %s\n", counter.name,
+                   std::strerror(errno));
+    }
+  }
+#endif
+}
+
+inline perf_counters::~perf_counters()
+{
+#ifdef __linux__
+  for (const auto& counter : _counters)
+  {
+    close(counter.second);
+  }
+#endif
+}
+
+inline void perf_counters::start() noexcept
+{
+#ifdef __linux__
+  // Enabling the parent event also enables its copies in child threads
+  for (const auto& counter : _counters)
+  {
+    ioctl(counter.second, PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+}
+
+inline void perf_counters::stop() noexcept
+{
+#ifdef __linux__
+  for (const auto& counter : _counters)
+  {
+    ioctl(counter.second, PERF_EVENT_IOC_DISABLE, 0);
+  }
+#endif
+}
+
+inline auto perf_counters::read_scaled(const int fd) noexcept -> double
+{
+#ifdef __linux__
+  // value, time enabled, time running; the value includes child threads
+  uint64_t values[3] = {};
+  if (read(fd, values, sizeof(values)) != sizeof(values) || values[2] == 0)
+  {
+    return 0.0;
+  }
+
+  return static_cast<double>(values[0]) * static_cast<double>(values[1]) /
+         static_cast<double>(values[2]);
+#else
+  static_cast<void>(fd);
+  return 0.0;
+#endif
+}
+
+inline void perf_counters::report(benchmark::State& state,
+                                  const double items) const
+{
+  if (items <= 0)
+  {
+    return;
+  }
+
+  double cycles = 0.0;
+  double instructions = 0.0;
+
+  for (const auto& counter : _counters)
+  {
+    const double value = read_scaled(counter.second);
+    state.counters[std::string(counter.first) + "_per_item"] = value / items;
+
+    if (std::strcmp(counter.first, "hw_cycles") == 0)
+    {
+      cycles = value;
+    }
+    else if (std::strcmp(counter.first, "instructions") == 0)
+    {
+      instructions = value;
+    }
+  }
+
+  if (cycles > 0.0 && instructions > 0.0)
+  {
+    state.counters["ipc"] = instructions / cycles;
+  }
+}
+
+// Times each iteration for UseManualTime() registrations and reports the same
+// throughput counters for every benchmark: items_per_second, ns_per_item and
+// cycles_per_item, the latter in tsc_clock ticks (reference cycles on x86),
+// along with the perf_counters of the iterations. Construct it before the
+// benchmark's worker threads so that their counts are included
+class throughput_meter
+{
+ public:
+  void start() noexcept;
+  void stop(benchmark::State& state) noexcept;
+
+  void report(benchmark::State& state, int64_t items_per_iteration) const;
+
+ private:
+  std::chrono::steady_clock::time_point _start_time{};
+  uint64_t _start_ticks{0};
+  double _total_ns{0.0};
+  double _total_ticks{0.0};
+  perf_counters _perf{};
+};
+
+inline void throughput_meter::start() noexcept
+{
+  _start_time = std::chrono::steady_clock::now();
+  _start_ticks = dq::tsc_clock::now();
+  _perf.start();
+}
+
+inline void throughput_meter::stop(benchmark::State& state) noexcept
+{
+  _perf.stop();
+  const uint64_t ticks = dq::tsc_clock::now() - _start_ticks;
+  const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - _start_time;
+
+  _total_ns += elapsed.count();
+  _total_ticks += static_cast<double>(ticks);
+  state.SetIterationTime(elapsed.count() / 1e9);
+}
+
+inline void throughput_meter::report(benchmark::State& state,
+                                     const int64_t items_per_iteration) const
+{
+  const auto items =
+      static_cast<double>(state.iterations() * items_per_iteration);
+
+  state.SetItemsProcessed(state.iterations() * items_per_iteration);
+  state.counters["ns_per_item"] = items > 0 ? _total_ns / items : 0.0;
+  state.counters["cycles_per_item"] = items > 0 ? _total_ticks / items : 0.0;
+  _perf.report(state, items);
+}
+
+// Reports a latency histogram recorded in tsc_clock ticks as p50_ns, p99_ns,
+// p99.9_ns, p99.99_ns and max_ns counters
+inline void report_latency_percentiles(benchmark::State& state,
+                                       const dq::histogram_snapshot& latency)
+{
+  const auto ns = [](const uint64_t ticks) {
+    return dq::tsc_clock::to_nanoseconds(ticks);
+  };
+
+  state.counters["p50_ns"] = ns(latency.value_at_percentile(50.0));
+  state.counters["p99_ns"] = ns(latency.value_at_percentile(99.0));
+  state.counters["p99.9_ns"] = ns(latency.value_at_percentile(99.9));
+  state.counters["p99.99_ns"] = ns(latency.value_at_percentile(99.99));
+  state.counters["max_ns"] = ns(latency.max());
+}
+
+}  // namespace dq::bench
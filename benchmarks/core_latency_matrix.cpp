@@ -0,0 +1,240 @@
+// Measures the one-way handoff latency of a disruptor ping-pong between every
+// ordered pair of CPUs and prints it as a matrix, to guide thread placement.
+//
+// usage: core_latency_matrix [--cpus=LIST] [--samples=N] [--format=csv|json]
+//
+// The row is the CPU that sends the ping, the column the CPU that answers. Each
+// cell is the median of N round trips, halved, in nanoseconds
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "disruptor_queue.hpp"
+#include "thread_placement.hpp"
+#include "tsc_clock.hpp"
+
+namespace
+{
+
+constexpr int64_t kWarmupRoundTrips = 10000;
+constexpr int64_t kStop = -1;
+
+struct options
+{
+  std::vector<int> cpus;
+  int64_t samples = 20000;
+  bool json = false;
+};
+
+bool parse_options(int argc, char** argv, options& parsed)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string_view argument = argv[i];
+
+    if (argument.rfind("--cpus=", 0) == 0)
+    {
+      parsed.cpus = dq::parse_cpu_list(argument.substr(7));
+      if (parsed.cpus.empty())
+      {
+        return false;
+      }
+    }
+    else if (argument.rfind("--samples=", 0) == 0)
+    {
+      parsed.samples = std::atoll(argv[i] + 10);
+      if (parsed.samples <= 0)
+      {
+        return false;
+      }
+    }
+    else if (argument == "--format=json")
+    {
+      parsed.json = true;
+    }
+    else if (argument != "--format=csv")
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Median one-way latency in ns, or a negative value if a thread could not be
+// pinned
+double measure_pair(const int ping_cpu, const int pong_cpu,
+                    const int64_t samples)
+{
+  dq::disruptor_queue<int64_t, 1024> request_queue;
+  dq::disruptor_queue<int64_t, 1024> response_queue;
+
+  auto& request_writer = request_queue.create_writer();
+  auto& request_reader = request_queue.create_reader();
+  auto& response_writer = response_queue.create_writer();
+  auto& response_reader = response_queue.create_reader();
+  request_queue.start();
+  response_queue.start();
+
+  const dq::scoped_thread_placement placement(ping_cpu);
+  bool pong_pinned = false;
+
+  std::thread pong([&]() {
+    pong_pinned = dq::place_current_thread(pong_cpu).pinned;
+
+    for (int64_t value = request_reader.read(); value != kStop;
+         value = request_reader.read())
+    {
+      response_writer.write(value);
+    }
+  });
+
+  for (int64_t i = 0; i < std::min(kWarmupRoundTrips, samples); ++i)
+  {
+    request_writer.write(i);
+    static_cast<void>(response_reader.read());
+  }
+
+  std::vector<uint64_t> round_trips(static_cast<std::size_t>(samples));
+
+  for (uint64_t& round_trip : round_trips)
+  {
+    const uint64_t start = dq::tsc_clock::now();
+    request_writer.write(0);
+    static_cast<void>(response_reader.read());
+    round_trip = dq::tsc_clock::now() - start;
+  }
+
+  request_writer.write(kStop);
+  pong.join();
+
+  if (!placement.result().pinned || !pong_pinned)
+  {
+    return -1.0;
+  }
+
+  const auto median = round_trips.begin() + samples / 2;
+  std::nth_element(round_trips.begin(), median, round_trips.end());
+  return dq::tsc_clock::to_nanoseconds(*median) / 2.0;
+}
+
+void print_csv(const std::vector<int>& cpus,
+               const std::vector<std::vector<double>>& matrix)
+{
+  std::printf("ping\\pong");
+  for (const int cpu : cpus)
+  {
+    std::printf(",%d", cpu);
+  }
+  std::printf("\n");
+
+  for (std::size_t row = 0; row < cpus.size(); ++row)
+  {
+    std::printf("%d", cpus[row]);
+    for (std::size_t column = 0; column < cpus.size(); ++column)
+    {
+      if (matrix[row][column] >= 0.0)
+      {
+        std::printf(",%.1f", matrix[row][column]);
+      }
+      else
+      {
+        std::printf(",");
+      }
+    }
+    std::printf("\n");
+  }
+}
+
+void print_json(const std::vector<int>& cpus,
+                const std::vector<std::vector<double>>& matrix)
+{
+  std::printf("{\"unit\":\"ns\",\"cpus\":[");
+  for (std::size_t i = 0; i < cpus.size(); ++i)
+  {
+    std::printf("%s%d", i == 0 ? "" : ",", cpus[i]);
+  }
+  std::printf("],\"one_way_latency\":[");
+
+  for (std::size_t row = 0; row < cpus.size(); ++row)
+  {
+    std::printf("%s\n[", row == 0 ? "" : ",");
+    for (std::size_t column = 0; column < cpus.size(); ++column)
+    {
+      const char* const separator = column == 0 ? "" : ",";
+      if (matrix[row][column] >= 0.0)
+      {
+        std::printf("%s%.1f", separator, matrix[row][column]);
+      }
+      else
+      {
+        std::printf("%snull", separator);
+      }
+    }
+    std::printf("]");
+  }
+
+  std::printf("\n]}\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  options parsed;
+
+  if (!parse_options(argc, argv, parsed))
+  {
+    std::fprintf(stderr,
+                 "usage: %s [--cpus=LIST] [--samples=N] [--format=csv|json]\n",
+                 argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (parsed.cpus.empty())
+  {
+    for (const dq::cpu_info& cpu : dq::cpu_topology::detect().cpus())
+    {
+      parsed.cpus.push_back(cpu.cpu);
+    }
+  }
+
+  if (parsed.cpus.size() < 2)
+  {
+    std::fprintf(stderr, "%s: need at least two CPUs\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const std::size_t count = parsed.cpus.size();
+  std::vector<std::vector<double>> matrix(count,
+                                          std::vector<double>(count, -1.0));
+
+  for (std::size_t row = 0; row < count; ++row)
+  {
+    for (std::size_t column = 0; column < count; ++column)
+    {
+      if (row != column)
+      {
+        matrix[row][column] = measure_pair(parsed.cpus[row],
+                                           parsed.cpus[column], parsed.samples);
+      }
+    }
+  }
+
+  if (parsed.json)
+  {
+    print_json(parsed.cpus, matrix);
+  }
+  else
+  {
+    print_csv(parsed.cpus, matrix);
+  }
+
+  return EXIT_SUCCESS;
+}
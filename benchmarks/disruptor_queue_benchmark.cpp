@@ -1,12 +1,20 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
 #include <atomic>
 #include <barrier>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <memory>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
+#include "baseline_queues.hpp"
+#include "benchmark_utils.hpp"
 #include "disruptor_queue.hpp"
 
 namespace
@@ -28,152 +36,157 @@ struct LargePayload
   int64_t values[64];  // 512 bytes
 };
 
-// Single producer, single consumer throughput benchmark
-// Measures steady-state throughput with queue reused across iterations
+// The queue the SPSC, fan-in and burst benchmarks run by default. They also
+// run the baselines in baseline_queues.hpp for comparison
 template <typename T, std::size_t CAPACITY>
+using disruptor = dq::disruptor_queue<T, CAPACITY>;
+
+// Thread roles of the two-thread benchmarks, see bench::benchmark_placement
+enum benchmark_role : std::size_t
+{
+  kProducer = 0,
+  kConsumer = 1,
+};
+
+// Single producer, single consumer throughput benchmark
+// The queue and the pinned consumer thread persist across iterations
+template <typename T, std::size_t CAPACITY,
+          template <typename, std::size_t> class QUEUE = disruptor>
 void BM_SPSC_Throughput(benchmark::State& state)
 {
+  const auto placement = dq::bench::place_benchmark_thread(kProducer, 2, state);
+
   const int64_t items_per_iteration = state.range(0);
 
+  auto queue = std::make_unique<QUEUE<T, CAPACITY>>();
+  auto& writer = queue->create_writer();
+  auto& reader = queue->create_reader();
+  queue->start();
+
+  dq::bench::throughput_meter meter;
+  dq::bench::persistent_workers consumer(1, kConsumer, 2, [&](std::size_t) {
+    for (int64_t i = 0; i < items_per_iteration; ++i)
+    {
+      benchmark::DoNotOptimize(reader.read());
+    }
+  });
+
   for (auto _ : state)
   {
-    dq::disruptor_queue<T, CAPACITY> queue;
-    auto& writer = queue.create_writer();
-    auto& reader = queue.create_reader();
-    queue.start();
-
-    std::thread consumer([&]() {
-      for (int64_t i = 0; i < items_per_iteration; ++i)
-      {
-        benchmark::DoNotOptimize(reader.read());
-      }
-    });
+    meter.start();
+    consumer.begin_round();
 
     for (int64_t i = 0; i < items_per_iteration; ++i)
     {
       writer.write(T{});
     }
 
-    consumer.join();
+    consumer.end_round();
+    meter.stop(state);
   }
 
-  state.SetItemsProcessed(state.iterations() * items_per_iteration);
+  meter.report(state, items_per_iteration);
   state.SetBytesProcessed(state.iterations() * items_per_iteration *
                           sizeof(T));
 }
 
 // Multiple readers (fan-out) benchmark
+// Every reader consumes every item, so an item here is one delivery
 template <typename T, std::size_t CAPACITY>
 void BM_SingleProducerMultiConsumer(benchmark::State& state)
 {
   const int num_readers = state.range(0);
   const int64_t items_per_iteration = state.range(1);
+  const std::size_t threads = num_readers + 1;
 
-  for (auto _ : state)
-  {
-    dq::disruptor_queue<T, CAPACITY> queue;
-    auto& writer = queue.create_writer();
+  const auto placement =
+      dq::bench::place_benchmark_thread(0, threads, state);
 
-    std::vector<typename dq::disruptor_queue<T, CAPACITY>::reader*> readers;
-    for (int i = 0; i < num_readers; ++i)
-    {
-      readers.push_back(&queue.create_reader());
-    }
-    queue.start();
+  auto queue = std::make_unique<dq::disruptor_queue<T, CAPACITY>>();
+  auto& writer = queue->create_writer();
 
-    std::vector<std::thread> consumers;
-    consumers.reserve(num_readers);
+  std::vector<typename dq::disruptor_queue<T, CAPACITY>::reader*> readers;
+  for (int i = 0; i < num_readers; ++i)
+  {
+    readers.push_back(&queue->create_reader());
+  }
+  queue->start();
 
-    for (int i = 0; i < num_readers; ++i)
-    {
-      consumers.emplace_back([&, i]() {
+  dq::bench::throughput_meter meter;
+  dq::bench::persistent_workers consumers(
+      num_readers, 1, threads, [&](const std::size_t reader) {
         for (int64_t j = 0; j < items_per_iteration; ++j)
         {
-          benchmark::DoNotOptimize(readers[i]->read());
+          benchmark::DoNotOptimize(readers[reader]->read());
         }
       });
-    }
+
+  for (auto _ : state)
+  {
+    meter.start();
+    consumers.begin_round();
 
     for (int64_t i = 0; i < items_per_iteration; ++i)
     {
       writer.write(T{});
     }
 
-    for (auto& t : consumers)
-    {
-      t.join();
-    }
+    consumers.end_round();
+    meter.stop(state);
   }
 
-  state.SetItemsProcessed(state.iterations() * items_per_iteration *
-                          num_readers);
+  meter.report(state, items_per_iteration * num_readers);
 }
 
-// Multiple writers benchmark - uses wall-clock timing for accuracy
-template <typename T, std::size_t CAPACITY>
+// Multiple writers (fan-in) benchmark - the benchmark's thread is the reader
+template <typename T, std::size_t CAPACITY,
+          template <typename, std::size_t> class QUEUE = disruptor>
 void BM_MultiProducerSingleConsumer(benchmark::State& state)
 {
   const int num_writers = state.range(0);
   const int64_t items_per_writer = state.range(1);
   const int64_t total_items = num_writers * items_per_writer;
+  const std::size_t threads = num_writers + 1;
 
-  double total_time_ns = 0;
-
-  for (auto _ : state)
-  {
-    dq::disruptor_queue<T, CAPACITY> queue;
-
-    std::vector<typename dq::disruptor_queue<T, CAPACITY>::writer*> writers;
-    for (int i = 0; i < num_writers; ++i)
-    {
-      writers.push_back(&queue.create_writer());
-    }
-
-    auto& reader = queue.create_reader();
-    queue.start();
+  const auto placement =
+      dq::bench::place_benchmark_thread(0, threads, state);
 
-    std::barrier start_barrier(num_writers + 2);
+  auto queue = std::make_unique<QUEUE<T, CAPACITY>>();
+  using writer_type = std::remove_reference_t<decltype(queue->create_writer())>;
 
-    std::thread consumer([&]() {
-      start_barrier.arrive_and_wait();
-      for (int64_t i = 0; i < total_items; ++i)
-      {
-        benchmark::DoNotOptimize(reader.read());
-      }
-    });
+  std::vector<writer_type*> writers;
+  for (int i = 0; i < num_writers; ++i)
+  {
+    writers.push_back(&queue->create_writer());
+  }
 
-    std::vector<std::thread> producers;
-    producers.reserve(num_writers);
+  auto& reader = queue->create_reader();
+  queue->start();
 
-    for (int i = 0; i < num_writers; ++i)
-    {
-      producers.emplace_back([&, i]() {
-        start_barrier.arrive_and_wait();
+  dq::bench::throughput_meter meter;
+  dq::bench::persistent_workers producers(
+      num_writers, 1, threads, [&](const std::size_t writer) {
         for (int64_t j = 0; j < items_per_writer; ++j)
         {
-          writers[i]->write(T{});
+          writers[writer]->write(T{});
         }
       });
-    }
 
-    auto start = std::chrono::high_resolution_clock::now();
-    start_barrier.arrive_and_wait();
+  for (auto _ : state)
+  {
+    meter.start();
+    producers.begin_round();
 
-    for (auto& t : producers)
+    for (int64_t i = 0; i < total_items; ++i)
     {
-      t.join();
+      benchmark::DoNotOptimize(reader.read());
     }
-    consumer.join();
 
-    auto end = std::chrono::high_resolution_clock::now();
-    total_time_ns +=
-        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
-            .count();
+    producers.end_round();
+    meter.stop(state);
   }
 
-  const double avg_time_s = total_time_ns / state.iterations() / 1e9;
-  state.counters["items_per_sec"] = total_items / avg_time_s;
-  state.counters["ns_per_item"] = total_time_ns / state.iterations() / total_items;
+  meter.report(state, total_items);
 }
 
 // Latency benchmark - measures per-item latency in steady state
@@ -181,6 +194,8 @@ void BM_MultiProducerSingleConsumer(benchmark::State& state)
 template <typename T, std::size_t CAPACITY>
 void BM_Latency(benchmark::State& state)
 {
+  const auto placement = dq::bench::place_benchmark_thread(kProducer, 2, state);
+
   dq::disruptor_queue<T, CAPACITY> queue;
   auto& writer = queue.create_writer();
   auto& reader = queue.create_reader();
@@ -190,6 +205,7 @@ void BM_Latency(benchmark::State& state)
   std::atomic<bool> stop{false};
 
   std::thread consumer([&]() {
+    dq::bench::place_benchmark_thread(kConsumer, 2);
     while (true)
     {
       // Wait for items
@@ -228,6 +244,8 @@ void BM_Latency(benchmark::State& state)
 template <typename T, std::size_t CAPACITY>
 void BM_PingPongLatency(benchmark::State& state)
 {
+  const auto placement = dq::bench::place_benchmark_thread(kProducer, 2, state);
+
   dq::disruptor_queue<T, CAPACITY> request_queue;
   dq::disruptor_queue<T, CAPACITY> response_queue;
 
@@ -242,6 +260,7 @@ void BM_PingPongLatency(benchmark::State& state)
 
   // Server thread: reads request, writes response
   std::thread server([&]() {
+    dq::bench::place_benchmark_thread(kConsumer, 2);
     while (!stop.load(std::memory_order_acquire))
     {
       T msg = request_reader.read();
@@ -271,16 +290,19 @@ void BM_PingPongLatency(benchmark::State& state)
 }
 
 // Burst write then read benchmark - excludes setup from timing
-template <typename T, std::size_t CAPACITY>
+template <typename T, std::size_t CAPACITY,
+          template <typename, std::size_t> class QUEUE = disruptor>
 void BM_BurstWriteRead(benchmark::State& state)
 {
+  const auto placement = dq::bench::place_benchmark_thread(kProducer, 2, state);
+
   const int64_t burst_size = state.range(0);
 
   for (auto _ : state)
   {
     state.PauseTiming();
 
-    dq::disruptor_queue<T, CAPACITY> queue;
+    QUEUE<T, CAPACITY> queue;
     auto& writer = queue.create_writer();
     auto& reader = queue.create_reader();
     queue.start();
@@ -288,6 +310,7 @@ void BM_BurstWriteRead(benchmark::State& state)
     std::barrier start_barrier(2);
 
     std::thread consumer([&]() {
+      dq::bench::place_benchmark_thread(kConsumer, 2);
       start_barrier.arrive_and_wait();
       for (int64_t i = 0; i < burst_size; ++i)
       {
@@ -380,6 +403,427 @@ void BM_WriterContention(benchmark::State& state)
       total_time_ns / (total_iterations * total_items);
 }
 
+// Backpressure benchmark - producer offers items faster than an artificially
+// slow consumer can take them; range(0) selects the writer's policy
+template <std::size_t CAPACITY>
+void BM_Backpressure(benchmark::State& state)
+{
+  const auto placement = dq::bench::place_benchmark_thread(kProducer, 2, state);
+
+  const auto policy = static_cast<dq::backpressure_policy>(state.range(0));
+  const int64_t items_per_iteration = state.range(1);
+  const int64_t consumer_delay_iterations = state.range(2);
+  constexpr int64_t kEndOfStream = -1;
+
+  int64_t total_published = 0;
+  uint64_t total_dropped = 0;
+
+  for (auto _ : state)
+  {
+    dq::disruptor_queue<SmallPayload, CAPACITY> queue;
+    auto& writer = queue.create_writer(policy);
+    auto& reader = queue.create_reader();
+    queue.start();
+
+    std::thread consumer([&]() {
+      dq::bench::place_benchmark_thread(kConsumer, 2);
+      while (reader.read().value != kEndOfStream)
+      {
+        for (int64_t i = 0; i < consumer_delay_iterations; ++i)
+        {
+          benchmark::DoNotOptimize(i);
+        }
+      }
+    });
+
+    for (int64_t i = 0; i < items_per_iteration; ++i)
+    {
+      total_published += writer.write(SmallPayload{i}) ? 1 : 0;
+    }
+    total_dropped += writer.dropped_count();
+
+    while (!writer.write(SmallPayload{kEndOfStream}))
+    {
+    }
+
+    consumer.join();
+  }
+
+  state.SetItemsProcessed(total_published);
+  state.counters["published_ratio"] =
+      static_cast<double>(total_published) /
+      static_cast<double>(state.iterations() * items_per_iteration);
+  state.counters["dropped_per_iteration"] =
+      static_cast<double>(total_dropped) /
+      static_cast<double>(state.iterations());
+}
+
+// Instrumentation overhead - write and read on one thread so that only the
+// hot-path hooks differ between instantiations, without scheduling noise
+template <typename INSTRUMENTATION>
+void BM_InstrumentationOverhead(benchmark::State& state)
+{
+  dq::disruptor_queue<SmallPayload, 1024, dq::busy_spin_wait_strategy,
+                      INSTRUMENTATION>
+      queue;
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  dq::bench::perf_counters counters;
+  int64_t value = 0;
+
+  counters.start();
+  for (auto _ : state)
+  {
+    writer.write(SmallPayload{value++});
+    benchmark::DoNotOptimize(reader.read());
+  }
+  counters.stop();
+
+  state.SetItemsProcessed(state.iterations());
+  counters.report(state, static_cast<double>(state.iterations()));
+}
+
+int64_t steady_now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int64_t thread_cpu_time_ns()
+{
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Arrival-rate benchmark - producer publishes one item every range(0) ns and
+// the consumer reports its mean latency and the share of wall time it spent
+// on CPU, showing how a wait strategy trades latency for idle CPU
+template <typename WAIT_STRATEGY>
+void BM_ArrivalRate(benchmark::State& state)
+{
+  const auto placement = dq::bench::place_benchmark_thread(kProducer, 2, state);
+
+  const int64_t interarrival_ns = state.range(0);
+  const int64_t items_per_iteration = state.range(1);
+
+  double total_latency_ns = 0;
+  double total_consumer_cpu_ns = 0;
+  double total_wall_ns = 0;
+
+  for (auto _ : state)
+  {
+    dq::disruptor_queue<SmallPayload, 1024, WAIT_STRATEGY> queue;
+    auto& writer = queue.create_writer();
+    auto& reader = queue.create_reader();
+    queue.start();
+
+    std::barrier start_barrier(2);
+    int64_t latency_ns = 0;
+    int64_t consumer_cpu_ns = 0;
+
+    std::thread consumer([&]() {
+      dq::bench::place_benchmark_thread(kConsumer, 2);
+      start_barrier.arrive_and_wait();
+      const int64_t cpu_start = thread_cpu_time_ns();
+      for (int64_t i = 0; i < items_per_iteration; ++i)
+      {
+        const SmallPayload payload = reader.read();
+        latency_ns += steady_now_ns() - payload.value;
+      }
+      consumer_cpu_ns = thread_cpu_time_ns() - cpu_start;
+    });
+
+    start_barrier.arrive_and_wait();
+    const int64_t start = steady_now_ns();
+    int64_t next_send = start;
+
+    for (int64_t i = 0; i < items_per_iteration; ++i)
+    {
+      while (steady_now_ns() < next_send)
+      {
+      }
+      writer.write(SmallPayload{steady_now_ns()});
+      next_send += interarrival_ns;
+    }
+
+    consumer.join();
+
+    total_wall_ns += static_cast<double>(steady_now_ns() - start);
+    total_latency_ns += static_cast<double>(latency_ns);
+    total_consumer_cpu_ns += static_cast<double>(consumer_cpu_ns);
+  }
+
+  state.SetItemsProcessed(state.iterations() * items_per_iteration);
+  state.counters["mean_latency_ns"] =
+      total_latency_ns /
+      static_cast<double>(state.iterations() * items_per_iteration);
+  state.counters["consumer_cpu_ratio"] = total_consumer_cpu_ns / total_wall_ns;
+}
+
+// Open-loop latency benchmark - the producer publishes on a fixed schedule of
+// range(0) items per second whether or not the consumer keeps up, and latency
+// is measured from each item's scheduled send time. A producer running late
+// still stamps the time it should have sent, so queueing delay behind a slow
+// consumer is counted instead of omitted
+template <typename WAIT_STRATEGY>
+void BM_OpenLoopLatency(benchmark::State& state)
+{
+  const auto placement = dq::bench::place_benchmark_thread(kProducer, 2, state);
+
+  const int64_t items_per_second = state.range(0);
+  const int64_t items_per_iteration = state.range(1);
+  const auto interval_ticks = static_cast<uint64_t>(
+      1e9 / static_cast<double>(items_per_second) /
+      dq::tsc_clock::to_nanoseconds(1));
+
+  auto queue =
+      std::make_unique<dq::disruptor_queue<uint64_t, 1024, WAIT_STRATEGY>>();
+  auto& writer = queue->create_writer();
+  auto& reader = queue->create_reader();
+  queue->start();
+
+  dq::latency_histogram latency;
+
+  dq::bench::throughput_meter meter;
+  dq::bench::persistent_workers consumer(1, kConsumer, 2, [&](std::size_t) {
+    for (int64_t i = 0; i < items_per_iteration; ++i)
+    {
+      const uint64_t intended = reader.read();
+      const uint64_t now = dq::tsc_clock::now();
+      latency.record(now > intended ? now - intended : 0);
+    }
+  });
+
+  for (auto _ : state)
+  {
+    meter.start();
+    consumer.begin_round();
+
+    uint64_t intended = dq::tsc_clock::now();
+    for (int64_t i = 0; i < items_per_iteration; ++i)
+    {
+      while (dq::tsc_clock::now() < intended)
+      {
+      }
+      writer.write(intended);
+      intended += interval_ticks;
+    }
+
+    consumer.end_round();
+    meter.stop(state);
+  }
+
+  meter.report(state, items_per_iteration);
+  dq::bench::report_latency_percentiles(state, latency.snapshot());
+}
+
+// Oversubscription - independent producer/consumer pairs with range(0)
+// threads per CPU, left to the scheduler as on a shared host. Latency is from
+// publish to consume across all pairs
+template <typename WAIT_STRATEGY>
+void BM_Oversubscribed(benchmark::State& state)
+{
+  using queue_type = dq::disruptor_queue<SmallPayload, 1024, WAIT_STRATEGY>;
+
+  const auto threads_per_cpu = static_cast<std::size_t>(state.range(0));
+  const int64_t items_per_pair = state.range(1);
+  const std::size_t cpus = std::max(1U, std::thread::hardware_concurrency());
+  const std::size_t pairs =
+      std::max<std::size_t>(1, cpus * threads_per_cpu / 2);
+
+  std::vector<std::unique_ptr<queue_type>> queues;
+  std::vector<std::unique_ptr<dq::latency_histogram>> latencies;
+  for (std::size_t i = 0; i < pairs; ++i)
+  {
+    queues.push_back(std::make_unique<queue_type>());
+    latencies.push_back(std::make_unique<dq::latency_histogram>());
+  }
+
+  std::vector<typename queue_type::writer*> writers;
+  std::vector<typename queue_type::reader*> readers;
+  for (const auto& queue : queues)
+  {
+    writers.push_back(&queue->create_writer());
+    readers.push_back(&queue->create_reader());
+    queue->start();
+  }
+
+  // Worker 2p writes pair p's queue and worker 2p + 1 reads it
+  dq::bench::throughput_meter meter;
+  dq::bench::persistent_workers workers(
+      2 * pairs, [&](const std::size_t worker) {
+        const std::size_t pair = worker / 2;
+
+        if (worker % 2 == 0)
+        {
+          for (int64_t i = 0; i < items_per_pair; ++i)
+          {
+            writers[pair]->write(
+                SmallPayload{static_cast<int64_t>(dq::tsc_clock::now())});
+          }
+          return;
+        }
+
+        for (int64_t i = 0; i < items_per_pair; ++i)
+        {
+          const auto sent = static_cast<uint64_t>(readers[pair]->read().value);
+          const uint64_t now = dq::tsc_clock::now();
+          latencies[pair]->record(now > sent ? now - sent : 0);
+        }
+      });
+
+  for (auto _ : state)
+  {
+    // Started before releasing the workers, which may otherwise run while
+    // this thread waits to be scheduled again
+    meter.start();
+    workers.begin_round();
+    workers.end_round();
+    meter.stop(state);
+  }
+
+  dq::histogram_snapshot latency;
+  for (const auto& pair_latency : latencies)
+  {
+    latency.merge(pair_latency->snapshot());
+  }
+
+  meter.report(state, items_per_pair * static_cast<int64_t>(pairs));
+  dq::bench::report_latency_percentiles(state, latency);
+  state.counters["threads"] = static_cast<double>(2 * pairs);
+}
+
+// Noisy neighbors for BM_NoisyNeighbor
+enum noisy_neighbor : int64_t
+{
+  kNoNeighbor = 0,
+  // Read-modify-writes cache lines of a buffer larger than most LLCs in a
+  // scattered order, evicting the queue's lines
+  kCacheThrasher = 1,
+  // Copies a large buffer back and forth, saturating memory bandwidth
+  kBandwidthHog = 2,
+};
+
+constexpr std::size_t kNeighborBufferBytes = std::size_t{64} << 20;
+
+void run_noisy_neighbor(const noisy_neighbor neighbor,
+                        const std::atomic<bool>& stop)
+{
+  constexpr std::size_t kLineWords = 64 / sizeof(uint64_t);
+  constexpr std::size_t kCopyChunkBytes = std::size_t{1} << 20;
+
+  std::vector<uint64_t> source(kNeighborBufferBytes / sizeof(uint64_t), 1);
+  std::vector<uint64_t> destination(
+      neighbor == kBandwidthHog ? source.size() : 0);
+
+  const std::size_t lines = source.size() / kLineWords;
+  std::size_t line = 0;
+  std::size_t offset = 0;
+
+  while (!stop.load(std::memory_order_relaxed))
+  {
+    if (neighbor == kCacheThrasher)
+    {
+      for (int i = 0; i < 4096; ++i)
+      {
+        // Full-period LCG over the power-of-two line count, which defeats
+        // the prefetchers
+        line = (line * 5 + 1) & (lines - 1);
+        ++source[line * kLineWords];
+      }
+    }
+    else
+    {
+      std::memcpy(reinterpret_cast<std::byte*>(destination.data()) + offset,
+                  reinterpret_cast<const std::byte*>(source.data()) + offset,
+                  kCopyChunkBytes);
+      benchmark::ClobberMemory();
+
+      offset += kCopyChunkBytes;
+      if (offset == kNeighborBufferBytes)
+      {
+        offset = 0;
+        source.swap(destination);
+      }
+    }
+  }
+}
+
+// Noisy neighbor - an SPSC pair with range(0) running alongside on a third
+// thread, placed as a third benchmark thread would be
+template <typename WAIT_STRATEGY>
+void BM_NoisyNeighbor(benchmark::State& state)
+{
+  enum : std::size_t
+  {
+    kNeighbor = 2,
+    kThreads = 3,
+  };
+
+  const auto neighbor = static_cast<noisy_neighbor>(state.range(0));
+  const int64_t items_per_iteration = state.range(1);
+
+  const auto placement =
+      dq::bench::place_benchmark_thread(kProducer, kThreads, state);
+
+  using queue_type = dq::disruptor_queue<SmallPayload, 1024, WAIT_STRATEGY>;
+
+  auto queue = std::make_unique<queue_type>();
+  auto& writer = queue->create_writer();
+  auto& reader = queue->create_reader();
+  queue->start();
+
+  std::atomic<bool> stop{false};
+  std::thread noise;
+  if (neighbor != kNoNeighbor)
+  {
+    noise = std::thread([&]() {
+      dq::bench::place_benchmark_thread(kNeighbor, kThreads);
+      run_noisy_neighbor(neighbor, stop);
+    });
+  }
+
+  // Built after the neighbor so that its counters leave the neighbor out
+  dq::bench::throughput_meter meter;
+  dq::latency_histogram latency;
+  dq::bench::persistent_workers consumer(
+      1, kConsumer, kThreads, [&](std::size_t) {
+        for (int64_t i = 0; i < items_per_iteration; ++i)
+        {
+          const auto sent = static_cast<uint64_t>(reader.read().value);
+          const uint64_t now = dq::tsc_clock::now();
+          latency.record(now > sent ? now - sent : 0);
+        }
+      });
+
+  for (auto _ : state)
+  {
+    meter.start();
+    consumer.begin_round();
+
+    for (int64_t i = 0; i < items_per_iteration; ++i)
+    {
+      writer.write(SmallPayload{static_cast<int64_t>(dq::tsc_clock::now())});
+    }
+
+    consumer.end_round();
+    meter.stop(state);
+  }
+
+  stop.store(true, std::memory_order_relaxed);
+  if (noise.joinable())
+  {
+    noise.join();
+  }
+
+  meter.report(state, items_per_iteration);
+  dq::bench::report_latency_percentiles(state, latency.snapshot());
+}
+
 // ==================== BENCHMARK REGISTRATIONS ====================
 
 // SPSC Throughput - Small payload
@@ -387,44 +831,90 @@ BENCHMARK(BM_SPSC_Throughput<SmallPayload, 1024>)
     ->Arg(10000)
     ->Arg(100000)
     ->Arg(1000000)
-    ->Unit(benchmark::kMicrosecond);
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
 
 // SPSC Throughput - Medium payload
 BENCHMARK(BM_SPSC_Throughput<MediumPayload, 1024>)
     ->Arg(10000)
     ->Arg(100000)
-    ->Unit(benchmark::kMicrosecond);
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
 
 // SPSC Throughput - Large payload
 BENCHMARK(BM_SPSC_Throughput<LargePayload, 1024>)
     ->Arg(10000)
     ->Arg(100000)
-    ->Unit(benchmark::kMicrosecond);
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
 
 // SPSC with different queue sizes
 BENCHMARK(BM_SPSC_Throughput<SmallPayload, 256>)
     ->Arg(100000)
-    ->Unit(benchmark::kMicrosecond);
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
 BENCHMARK(BM_SPSC_Throughput<SmallPayload, 4096>)
     ->Arg(100000)
-    ->Unit(benchmark::kMicrosecond);
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
 BENCHMARK(BM_SPSC_Throughput<SmallPayload, 65536>)
     ->Arg(100000)
-    ->Unit(benchmark::kMicrosecond);
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+
+// SPSC Throughput - baseline queues
+BENCHMARK(BM_SPSC_Throughput<SmallPayload, 1024, dq::bench::mutex_deque_queue>)
+    ->Arg(100000)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_SPSC_Throughput<SmallPayload, 1024, dq::bench::condvar_queue>)
+    ->Arg(100000)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_SPSC_Throughput<SmallPayload, 1024, dq::bench::vyukov_mpmc_queue>)
+    ->Arg(100000)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_SPSC_Throughput<SmallPayload, 1024, dq::bench::lamport_spsc_queue>)
+    ->Arg(100000)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
 
 // Fan-out: 1 producer, N consumers
 BENCHMARK(BM_SingleProducerMultiConsumer<SmallPayload, 1024>)
     ->Args({2, 100000})
     ->Args({4, 100000})
     ->Args({8, 100000})
-    ->Unit(benchmark::kMicrosecond);
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
 
 // Fan-in: N producers, 1 consumer (fixed)
 BENCHMARK(BM_MultiProducerSingleConsumer<SmallPayload, 1024>)
     ->Args({2, 50000})
     ->Args({4, 25000})
     ->Args({8, 12500})
-    ->Unit(benchmark::kMicrosecond);
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+
+// Fan-in - baseline queues, except the single-producer Lamport ring
+BENCHMARK(BM_MultiProducerSingleConsumer<SmallPayload, 1024,
+                                         dq::bench::mutex_deque_queue>)
+    ->Args({2, 50000})
+    ->Args({4, 25000})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MultiProducerSingleConsumer<SmallPayload, 1024,
+                                         dq::bench::condvar_queue>)
+    ->Args({2, 50000})
+    ->Args({4, 25000})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MultiProducerSingleConsumer<SmallPayload, 1024,
+                                         dq::bench::vyukov_mpmc_queue>)
+    ->Args({2, 50000})
+    ->Args({4, 25000})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
 
 // Writer contention benchmark (constant total work)
 BENCHMARK(BM_WriterContention<SmallPayload, 4096>)
@@ -446,4 +936,106 @@ BENCHMARK(BM_BurstWriteRead<SmallPayload, 1024>)
     ->Arg(1024)
     ->Unit(benchmark::kMicrosecond);
 
+// Burst patterns - baseline queues
+BENCHMARK(BM_BurstWriteRead<SmallPayload, 1024, dq::bench::mutex_deque_queue>)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BurstWriteRead<SmallPayload, 1024, dq::bench::condvar_queue>)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BurstWriteRead<SmallPayload, 1024, dq::bench::vyukov_mpmc_queue>)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BurstWriteRead<SmallPayload, 1024, dq::bench::lamport_spsc_queue>)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Unit(benchmark::kMicrosecond);
+
+// Backpressure policies against a slow consumer:
+// {policy, items, consumer delay iterations per item}
+BENCHMARK(BM_Backpressure<1024>)
+    ->ArgNames({"policy", "items", "delay"})
+    ->Args({static_cast<int64_t>(dq::backpressure_policy::block), 100000, 200})
+    ->Args({static_cast<int64_t>(dq::backpressure_policy::spin_then_park),
+            100000, 200})
+    ->Args({static_cast<int64_t>(dq::backpressure_policy::fail), 100000, 200})
+    ->Args({static_cast<int64_t>(dq::backpressure_policy::drop_newest), 100000,
+            200})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// Instrumentation: no_instrumentation should match the uninstrumented hot path
+BENCHMARK(BM_InstrumentationOverhead<dq::no_instrumentation>)
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_InstrumentationOverhead<dq::counting_instrumentation>)
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_InstrumentationOverhead<dq::latency_instrumentation<>>)
+    ->Unit(benchmark::kNanosecond);
+
+// Wait strategies across arrival rates: {interarrival ns, items}
+BENCHMARK(BM_ArrivalRate<dq::busy_spin_wait_strategy>)
+    ->ArgNames({"interarrival_ns", "items"})
+    ->Args({250, 100000})
+    ->Args({1000, 50000})
+    ->Args({10000, 5000})
+    ->Args({100000, 1000})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ArrivalRate<dq::adaptive_wait_strategy>)
+    ->ArgNames({"interarrival_ns", "items"})
+    ->Args({250, 100000})
+    ->Args({1000, 50000})
+    ->Args({10000, 5000})
+    ->Args({100000, 1000})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Open-loop latency at 100k and 1M items per second
+BENCHMARK(BM_OpenLoopLatency<dq::busy_spin_wait_strategy>)
+    ->ArgNames({"items_per_second", "items"})
+    ->Args({100000, 100000})
+    ->Args({1000000, 1000000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+BENCHMARK(BM_OpenLoopLatency<dq::adaptive_wait_strategy>)
+    ->ArgNames({"items_per_second", "items"})
+    ->Args({100000, 100000})
+    ->Args({1000000, 1000000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+// Shared hosts: more threads than CPUs, and a cache or bandwidth hog next to
+// an SPSC pair, per wait strategy
+BENCHMARK(BM_Oversubscribed<dq::busy_spin_wait_strategy>)
+    ->ArgNames({"threads_per_cpu", "items"})
+    ->Args({1, 20000})
+    ->Args({2, 20000})
+    ->Args({4, 20000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+BENCHMARK(BM_Oversubscribed<dq::adaptive_wait_strategy>)
+    ->ArgNames({"threads_per_cpu", "items"})
+    ->Args({1, 20000})
+    ->Args({2, 20000})
+    ->Args({4, 20000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+BENCHMARK(BM_NoisyNeighbor<dq::busy_spin_wait_strategy>)
+    ->ArgNames({"neighbor", "items"})
+    ->Args({kNoNeighbor, 100000})
+    ->Args({kCacheThrasher, 100000})
+    ->Args({kBandwidthHog, 100000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+BENCHMARK(BM_NoisyNeighbor<dq::adaptive_wait_strategy>)
+    ->ArgNames({"neighbor", "items"})
+    ->Args({kNoNeighbor, 100000})
+    ->Args({kCacheThrasher, 100000})
+    ->Args({kBandwidthHog, 100000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
 }  // namespace
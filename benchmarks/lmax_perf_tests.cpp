@@ -0,0 +1,422 @@
+// Ports of the LMAX Disruptor performance tests, for comparison with the Java
+// reference. Each handler does the reference's arithmetic and every round is
+// checked against the result of running it serially.
+//
+// Readers here cannot gate on one another, so where the reference has
+// handlers depend on earlier handlers in one ring buffer, the pipeline and
+// diamond hand each stage's results to the next through its own queue.
+// OneToThreeWorkerPoolThroughputTest is not ported: every reader of the queue
+// consumes every event, and it has no consumer that shares events out
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark_utils.hpp"
+#include "disruptor_queue.hpp"
+#include "latency_histogram.hpp"
+#include "tsc_clock.hpp"
+
+namespace
+{
+
+// The reference's ring sizes
+constexpr std::size_t kSequencedBufferSize = 1024 * 64;
+constexpr std::size_t kPipelineBufferSize = 1024 * 8;
+constexpr std::size_t kDiamondBufferSize = 1024 * 8;
+constexpr std::size_t kPingPongBufferSize = 1024;
+
+constexpr int64_t kIterations = 10000000;
+constexpr int64_t kPipelineOperandTwoInitialValue = 777;
+constexpr int64_t kPingPongPauseNs = 1000;
+
+bool verify(benchmark::State& state, const int64_t actual,
+            const int64_t expected)
+{
+  if (actual != expected)
+  {
+    state.SkipWithError("Handler result does not match the serial result");
+    return false;
+  }
+
+  return true;
+}
+
+// OneToOneSequencedThroughputTest: one publisher, one summing handler
+void BM_OneToOneSequencedThroughput(benchmark::State& state)
+{
+  const int64_t iterations = state.range(0);
+  const auto placement = dq::bench::place_benchmark_thread(0, 2, state);
+
+  auto queue =
+      std::make_unique<dq::disruptor_queue<int64_t, kSequencedBufferSize>>();
+  auto& writer = queue->create_writer();
+  auto& reader = queue->create_reader();
+  queue->start();
+
+  int64_t sum = 0;
+  dq::bench::throughput_meter meter;
+  dq::bench::persistent_workers handler(1, 1, 2, [&](std::size_t) {
+    sum = 0;
+    for (int64_t i = 0; i < iterations; ++i)
+    {
+      sum += reader.read();
+    }
+  });
+
+  const int64_t expected = iterations * (iterations - 1) / 2;
+
+  for (auto _ : state)
+  {
+    meter.start();
+    handler.begin_round();
+
+    for (int64_t i = 0; i < iterations; ++i)
+    {
+      writer.write(i);
+    }
+
+    handler.end_round();
+    meter.stop(state);
+
+    if (!verify(state, sum, expected))
+    {
+      break;
+    }
+  }
+
+  meter.report(state, iterations);
+}
+
+struct function_event
+{
+  int64_t operand_one;
+  int64_t operand_two;
+  int64_t step_one_result;
+  int64_t step_two_result;
+};
+
+// OneToThreePipelineSequencedThroughputTest: three handlers in series, the
+// last counting results with bit 2 set
+void BM_OneToThreePipelineThroughput(benchmark::State& state)
+{
+  using queue_type = dq::disruptor_queue<function_event, kPipelineBufferSize>;
+
+  const int64_t iterations = state.range(0);
+  const auto placement = dq::bench::place_benchmark_thread(0, 4, state);
+
+  auto step_one_queue = std::make_unique<queue_type>();
+  auto step_two_queue = std::make_unique<queue_type>();
+  auto step_three_queue = std::make_unique<queue_type>();
+
+  auto& writer = step_one_queue->create_writer();
+  auto& step_one_reader = step_one_queue->create_reader();
+  auto& step_one_writer = step_two_queue->create_writer();
+  auto& step_two_reader = step_two_queue->create_reader();
+  auto& step_two_writer = step_three_queue->create_writer();
+  auto& step_three_reader = step_three_queue->create_reader();
+  step_one_queue->start();
+  step_two_queue->start();
+  step_three_queue->start();
+
+  int64_t counter = 0;
+  dq::bench::throughput_meter meter;
+  dq::bench::persistent_workers handlers(
+      3, 1, 4, [&](const std::size_t step) {
+        if (step == 2)
+        {
+          counter = 0;
+        }
+
+        for (int64_t i = 0; i < iterations; ++i)
+        {
+          if (step == 0)
+          {
+            function_event event = step_one_reader.read();
+            event.step_one_result = event.operand_one + event.operand_two;
+            step_one_writer.write(event);
+          }
+          else if (step == 1)
+          {
+            function_event event = step_two_reader.read();
+            event.step_two_result = event.step_one_result + 3;
+            step_two_writer.write(event);
+          }
+          else
+          {
+            if ((step_three_reader.read().step_two_result & 4) == 4)
+            {
+              ++counter;
+            }
+          }
+        }
+      });
+
+  int64_t expected = 0;
+  int64_t operand_two = kPipelineOperandTwoInitialValue;
+  for (int64_t i = 0; i < iterations; ++i)
+  {
+    const int64_t step_two_result = i + operand_two-- + 3;
+    if ((step_two_result & 4) == 4)
+    {
+      ++expected;
+    }
+  }
+
+  for (auto _ : state)
+  {
+    meter.start();
+    handlers.begin_round();
+
+    operand_two = kPipelineOperandTwoInitialValue;
+    for (int64_t i = 0; i < iterations; ++i)
+    {
+      writer.write(function_event{i, operand_two--, 0, 0});
+    }
+
+    handlers.end_round();
+    meter.stop(state);
+
+    if (!verify(state, counter, expected))
+    {
+      break;
+    }
+  }
+
+  meter.report(state, iterations);
+}
+
+// OneToThreeDiamondSequencedThroughputTest: fizz and buzz handlers in
+// parallel, joined by a handler counting values that are both
+void BM_OneToThreeDiamondThroughput(benchmark::State& state)
+{
+  const int64_t iterations = state.range(0);
+  const auto placement = dq::bench::place_benchmark_thread(0, 4, state);
+
+  auto values = std::make_unique<
+      dq::disruptor_queue<int64_t, kDiamondBufferSize>>();
+  auto fizz_results =
+      std::make_unique<dq::disruptor_queue<bool, kDiamondBufferSize>>();
+  auto buzz_results =
+      std::make_unique<dq::disruptor_queue<bool, kDiamondBufferSize>>();
+
+  auto& writer = values->create_writer();
+  auto& fizz_reader = values->create_reader();
+  auto& buzz_reader = values->create_reader();
+  auto& fizz_writer = fizz_results->create_writer();
+  auto& buzz_writer = buzz_results->create_writer();
+  auto& join_fizz_reader = fizz_results->create_reader();
+  auto& join_buzz_reader = buzz_results->create_reader();
+  values->start();
+  fizz_results->start();
+  buzz_results->start();
+
+  int64_t fizz_buzz_counter = 0;
+  dq::bench::throughput_meter meter;
+  dq::bench::persistent_workers handlers(
+      3, 1, 4, [&](const std::size_t handler) {
+        if (handler == 2)
+        {
+          fizz_buzz_counter = 0;
+        }
+
+        for (int64_t i = 0; i < iterations; ++i)
+        {
+          if (handler == 0)
+          {
+            fizz_writer.write(fizz_reader.read() % 3 == 0);
+          }
+          else if (handler == 1)
+          {
+            buzz_writer.write(buzz_reader.read() % 5 == 0);
+          }
+          else
+          {
+            const bool fizz = join_fizz_reader.read();
+            const bool buzz = join_buzz_reader.read();
+            if (fizz && buzz)
+            {
+              ++fizz_buzz_counter;
+            }
+          }
+        }
+      });
+
+  int64_t expected = 0;
+  for (int64_t i = 0; i < iterations; ++i)
+  {
+    if (i % 3 == 0 && i % 5 == 0)
+    {
+      ++expected;
+    }
+  }
+
+  for (auto _ : state)
+  {
+    meter.start();
+    handlers.begin_round();
+
+    for (int64_t i = 0; i < iterations; ++i)
+    {
+      writer.write(i);
+    }
+
+    handlers.end_round();
+    meter.stop(state);
+
+    if (!verify(state, fizz_buzz_counter, expected))
+    {
+      break;
+    }
+  }
+
+  meter.report(state, iterations);
+}
+
+// ThreeToOneSequencedThroughputTest: three publishers, one summing handler on
+// the benchmark's thread
+void BM_ThreeToOneSequencedThroughput(benchmark::State& state)
+{
+  constexpr std::size_t kPublishers = 3;
+
+  using queue_type = dq::disruptor_queue<int64_t, kSequencedBufferSize>;
+
+  const int64_t iterations_per_publisher =
+      state.range(0) / static_cast<int64_t>(kPublishers);
+  const int64_t iterations =
+      iterations_per_publisher * static_cast<int64_t>(kPublishers);
+  const auto placement =
+      dq::bench::place_benchmark_thread(0, kPublishers + 1, state);
+
+  auto queue = std::make_unique<queue_type>();
+
+  std::vector<queue_type::writer*> writers;
+  for (std::size_t i = 0; i < kPublishers; ++i)
+  {
+    writers.push_back(&queue->create_writer());
+  }
+
+  auto& reader = queue->create_reader();
+  queue->start();
+
+  dq::bench::throughput_meter meter;
+  dq::bench::persistent_workers publishers(
+      kPublishers, 1, kPublishers + 1, [&](const std::size_t publisher) {
+        for (int64_t i = 0; i < iterations_per_publisher; ++i)
+        {
+          writers[publisher]->write(i);
+        }
+      });
+
+  const int64_t expected = static_cast<int64_t>(kPublishers) *
+                           iterations_per_publisher *
+                           (iterations_per_publisher - 1) / 2;
+
+  for (auto _ : state)
+  {
+    meter.start();
+    publishers.begin_round();
+
+    int64_t sum = 0;
+    for (int64_t i = 0; i < iterations; ++i)
+    {
+      sum += reader.read();
+    }
+
+    publishers.end_round();
+    meter.stop(state);
+
+    if (!verify(state, sum, expected))
+    {
+      break;
+    }
+  }
+
+  meter.report(state, iterations);
+}
+
+// PingPongSequencedLatencyTest: the pinger sends its timestamp, pauses and
+// records the round trip once the ponger echoes it. Percentiles are round
+// trips, twice the one-way latency
+void BM_PingPongSequencedLatency(benchmark::State& state)
+{
+  using queue_type = dq::disruptor_queue<uint64_t, kPingPongBufferSize>;
+
+  const int64_t iterations = state.range(0);
+  const auto placement = dq::bench::place_benchmark_thread(0, 2, state);
+
+  auto pings = std::make_unique<queue_type>();
+  auto pongs = std::make_unique<queue_type>();
+  auto& ping_writer = pings->create_writer();
+  auto& ping_reader = pings->create_reader();
+  auto& pong_writer = pongs->create_writer();
+  auto& pong_reader = pongs->create_reader();
+  pings->start();
+  pongs->start();
+
+  dq::latency_histogram round_trips;
+  dq::bench::persistent_workers ponger(1, 1, 2, [&](std::size_t) {
+    for (int64_t i = 0; i < iterations; ++i)
+    {
+      pong_writer.write(ping_reader.read());
+    }
+  });
+
+  const auto pause_ticks = static_cast<uint64_t>(
+      kPingPongPauseNs / dq::tsc_clock::to_nanoseconds(1));
+
+  for (auto _ : state)
+  {
+    ponger.begin_round();
+
+    int64_t echoed = 0;
+    for (int64_t i = 0; i < iterations; ++i)
+    {
+      const uint64_t sent = dq::tsc_clock::now();
+      ping_writer.write(sent);
+      echoed += pong_reader.read() == sent ? 1 : 0;
+
+      const uint64_t received = dq::tsc_clock::now();
+      round_trips.record(received - sent);
+
+      while (dq::tsc_clock::now() - received < pause_ticks)
+      {
+      }
+    }
+
+    ponger.end_round();
+
+    if (!verify(state, echoed, iterations))
+    {
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * iterations);
+  dq::bench::report_latency_percentiles(state, round_trips.snapshot());
+}
+
+BENCHMARK(BM_OneToOneSequencedThroughput)
+    ->Arg(kIterations)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+BENCHMARK(BM_OneToThreePipelineThroughput)
+    ->Arg(kIterations)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+BENCHMARK(BM_OneToThreeDiamondThroughput)
+    ->Arg(kIterations)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+BENCHMARK(BM_ThreeToOneSequencedThroughput)
+    ->Arg(kIterations)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+BENCHMARK(BM_PingPongSequencedLatency)
+    ->Arg(1000000)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,429 @@
+// Sweeps offered load from 10% to 120% of measured saturation and prints the
+// throughput-versus-latency curve of each configuration.
+//
+// usage: load_sweep [--topology=spsc|fanout|fanin|all] [--fan=N] [--items=N]
+//                   [--format=csv|json]
+//
+// For each topology, capacity, payload size and wait strategy, saturation is
+// the throughput with unpaced producers. Each step then paces producers
+// open-loop at a fraction of it and measures latency from every item's
+// scheduled send time, so queueing delay past saturation shows up in full.
+// Fan-out and fan-in use --fan readers or writers (2 by default), and their
+// offered load counts items published. Fan-in splits --items between its
+// writers, so when it runs there must be at least one per writer
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.hpp"
+#include "disruptor_queue.hpp"
+#include "latency_histogram.hpp"
+#include "tsc_clock.hpp"
+
+namespace
+{
+
+enum class topology
+{
+  spsc,
+  fanout,
+  fanin,
+};
+
+const char* to_string(const topology shape)
+{
+  switch (shape)
+  {
+    case topology::spsc:
+      return "spsc";
+    case topology::fanout:
+      return "fanout";
+    case topology::fanin:
+      return "fanin";
+  }
+
+  return "unknown";
+}
+
+constexpr double kLoadFractions[] = {0.1, 0.2, 0.3, 0.4, 0.5, 0.6,
+                                     0.7, 0.8, 0.9, 1.0, 1.1, 1.2};
+
+// Lets every thread reach its spin loop before the first scheduled send
+constexpr double kStartDelayNs = 5e6;
+
+template <std::size_t BYTES>
+struct payload
+{
+  static_assert(BYTES >= sizeof(uint64_t), "Payload must hold a timestamp");
+
+  // Scheduled send time in tsc_clock ticks
+  uint64_t intended;
+  std::byte padding[BYTES - sizeof(uint64_t)];
+};
+
+struct options
+{
+  std::vector<topology> topologies{topology::spsc, topology::fanout,
+                                   topology::fanin};
+  std::size_t fan = 2;
+  int64_t items = 200000;
+  bool json = false;
+};
+
+struct load_point
+{
+  double fraction;
+  double offered_per_second;
+  double achieved_per_second;
+  dq::histogram_snapshot latency;
+};
+
+struct curve
+{
+  topology shape;
+  std::size_t capacity;
+  std::size_t payload_bytes;
+  const char* wait_strategy;
+  double saturation_per_second;
+  std::vector<load_point> points;
+};
+
+// Runs items through the topology with producers paced at items_per_second in
+// total, or unpaced when it is zero
+template <typename PAYLOAD, std::size_t CAPACITY, typename WAIT_STRATEGY>
+load_point run_load_point(const topology shape, const std::size_t fan,
+                          const int64_t items, const double items_per_second)
+{
+  using queue_type = dq::disruptor_queue<PAYLOAD, CAPACITY, WAIT_STRATEGY>;
+
+  const std::size_t writer_count = shape == topology::fanin ? fan : 1;
+  const std::size_t reader_count = shape == topology::fanout ? fan : 1;
+  const std::size_t threads = writer_count + reader_count;
+  const auto items_per_writer = items / static_cast<int64_t>(writer_count);
+  const int64_t total_items =
+      items_per_writer * static_cast<int64_t>(writer_count);
+
+  auto queue = std::make_unique<queue_type>();
+
+  std::vector<typename queue_type::writer*> writers;
+  for (std::size_t i = 0; i < writer_count; ++i)
+  {
+    writers.push_back(&queue->create_writer());
+  }
+
+  std::vector<typename queue_type::reader*> readers;
+  std::vector<std::unique_ptr<dq::latency_histogram>> latencies;
+  std::vector<uint64_t> finish_ticks(reader_count, 0);
+  for (std::size_t i = 0; i < reader_count; ++i)
+  {
+    readers.push_back(&queue->create_reader());
+    latencies.push_back(std::make_unique<dq::latency_histogram>());
+  }
+  queue->start();
+
+  const double ns_per_tick = dq::tsc_clock::to_nanoseconds(1);
+  const double interval_ticks =
+      items_per_second > 0.0 ? 1e9 / items_per_second / ns_per_tick : 0.0;
+
+  std::barrier ready(static_cast<std::ptrdiff_t>(threads + 1));
+  std::atomic<uint64_t> origin{0};
+  std::vector<std::thread> workers;
+
+  for (std::size_t w = 0; w < writer_count; ++w)
+  {
+    workers.emplace_back([&, w]() {
+      dq::bench::place_benchmark_thread(w, threads);
+      ready.arrive_and_wait();
+
+      const uint64_t start = origin.load(std::memory_order_acquire);
+      while (dq::tsc_clock::now() < start)
+      {
+      }
+
+      for (int64_t i = 0; i < items_per_writer; ++i)
+      {
+        // Writers interleave their slots of the shared schedule
+        const auto slot = static_cast<double>(
+            i * static_cast<int64_t>(writer_count) +
+            static_cast<int64_t>(w));
+        PAYLOAD item{};
+        item.intended = start + static_cast<uint64_t>(slot * interval_ticks);
+
+        if (interval_ticks > 0.0)
+        {
+          while (dq::tsc_clock::now() < item.intended)
+          {
+          }
+        }
+        else
+        {
+          item.intended = dq::tsc_clock::now();
+        }
+
+        writers[w]->write(item);
+      }
+    });
+  }
+
+  for (std::size_t r = 0; r < reader_count; ++r)
+  {
+    workers.emplace_back([&, r]() {
+      dq::bench::place_benchmark_thread(writer_count + r, threads);
+      ready.arrive_and_wait();
+
+      for (int64_t i = 0; i < total_items; ++i)
+      {
+        const uint64_t intended = readers[r]->read().intended;
+        const uint64_t now = dq::tsc_clock::now();
+        latencies[r]->record(now > intended ? now - intended : 0);
+      }
+
+      finish_ticks[r] = dq::tsc_clock::now();
+    });
+  }
+
+  origin.store(dq::tsc_clock::now() +
+                   static_cast<uint64_t>(kStartDelayNs / ns_per_tick),
+               std::memory_order_release);
+  ready.arrive_and_wait();
+
+  for (std::thread& worker : workers)
+  {
+    worker.join();
+  }
+
+  load_point point{};
+  point.offered_per_second = items_per_second;
+
+  const uint64_t finish =
+      *std::max_element(finish_ticks.begin(), finish_ticks.end());
+  const double elapsed_ns =
+      dq::tsc_clock::to_nanoseconds(finish - origin.load());
+  point.achieved_per_second =
+      elapsed_ns > 0.0 ? static_cast<double>(total_items) * 1e9 / elapsed_ns
+                       : 0.0;
+
+  for (const auto& latency : latencies)
+  {
+    point.latency.merge(latency->snapshot());
+  }
+
+  return point;
+}
+
+template <typename PAYLOAD, std::size_t CAPACITY, typename WAIT_STRATEGY>
+curve sweep(const topology shape, const options& parsed,
+            const char* wait_strategy)
+{
+  curve result{shape, CAPACITY, sizeof(PAYLOAD), wait_strategy, 0.0, {}};
+
+  result.saturation_per_second =
+      run_load_point<PAYLOAD, CAPACITY, WAIT_STRATEGY>(shape, parsed.fan,
+                                                       parsed.items, 0.0)
+          .achieved_per_second;
+
+  for (const double fraction : kLoadFractions)
+  {
+    load_point point = run_load_point<PAYLOAD, CAPACITY, WAIT_STRATEGY>(
+        shape, parsed.fan, parsed.items,
+        fraction * result.saturation_per_second);
+    point.fraction = fraction;
+    result.points.push_back(std::move(point));
+  }
+
+  return result;
+}
+
+std::vector<curve> run_sweeps(const options& parsed)
+{
+  std::vector<curve> curves;
+
+  for (const topology shape : parsed.topologies)
+  {
+    curves.push_back(sweep<payload<16>, 1024, dq::busy_spin_wait_strategy>(
+        shape, parsed, "busy_spin"));
+    curves.push_back(sweep<payload<16>, 1024, dq::adaptive_wait_strategy>(
+        shape, parsed, "adaptive"));
+    curves.push_back(sweep<payload<256>, 1024, dq::busy_spin_wait_strategy>(
+        shape, parsed, "busy_spin"));
+    curves.push_back(sweep<payload<16>, 65536, dq::busy_spin_wait_strategy>(
+        shape, parsed, "busy_spin"));
+  }
+
+  return curves;
+}
+
+double ns(const uint64_t ticks)
+{
+  return dq::tsc_clock::to_nanoseconds(ticks);
+}
+
+void print_csv(const std::vector<curve>& curves)
+{
+  std::printf(
+      "topology,capacity,payload_bytes,wait_strategy,load_fraction,"
+      "offered_per_second,achieved_per_second,p50_ns,p99_ns,p99.9_ns,"
+      "p99.99_ns,max_ns\n");
+
+  for (const curve& config : curves)
+  {
+    for (const load_point& point : config.points)
+    {
+      std::printf("%s,%zu,%zu,%s,%.2f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f\n",
+                  to_string(config.shape), config.capacity,
+                  config.payload_bytes, config.wait_strategy, point.fraction,
+                  point.offered_per_second, point.achieved_per_second,
+                  ns(point.latency.value_at_percentile(50.0)),
+                  ns(point.latency.value_at_percentile(99.0)),
+                  ns(point.latency.value_at_percentile(99.9)),
+                  ns(point.latency.value_at_percentile(99.99)),
+                  ns(point.latency.max()));
+    }
+  }
+}
+
+void print_json(const std::vector<curve>& curves)
+{
+  std::printf("[");
+
+  for (std::size_t c = 0; c < curves.size(); ++c)
+  {
+    const curve& config = curves[c];
+    std::printf(
+        "%s\n{\"topology\":\"%s\",\"capacity\":%zu,\"payload_bytes\":%zu,"
+        "\"wait_strategy\":\"%s\",\"saturation_per_second\":%.0f,"
+        "\"curve\":[",
+        c == 0 ? "" : ",", to_string(config.shape), config.capacity,
+        config.payload_bytes, config.wait_strategy,
+        config.saturation_per_second);
+
+    for (std::size_t p = 0; p < config.points.size(); ++p)
+    {
+      const load_point& point = config.points[p];
+      std::printf(
+          "%s\n  {\"load_fraction\":%.2f,\"offered_per_second\":%.0f,"
+          "\"achieved_per_second\":%.0f,\"p50_ns\":%.0f,\"p99_ns\":%.0f,"
+          "\"p99.9_ns\":%.0f,\"p99.99_ns\":%.0f,\"max_ns\":%.0f}",
+          p == 0 ? "" : ",", point.fraction, point.offered_per_second,
+          point.achieved_per_second,
+          ns(point.latency.value_at_percentile(50.0)),
+          ns(point.latency.value_at_percentile(99.0)),
+          ns(point.latency.value_at_percentile(99.9)),
+          ns(point.latency.value_at_percentile(99.99)),
+          ns(point.latency.max()));
+    }
+
+    std::printf("]}");
+  }
+
+  std::printf("\n]\n");
+}
+
+bool parse_options(int argc, char** argv, options& parsed)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string_view argument = argv[i];
+
+    if (argument.rfind("--topology=", 0) == 0)
+    {
+      const std::string_view name = argument.substr(11);
+      if (name == "all")
+      {
+        continue;
+      }
+
+      parsed.topologies.clear();
+      for (const topology shape :
+           {topology::spsc, topology::fanout, topology::fanin})
+      {
+        if (name == to_string(shape))
+        {
+          parsed.topologies.push_back(shape);
+        }
+      }
+      if (parsed.topologies.empty())
+      {
+        return false;
+      }
+    }
+    else if (argument.rfind("--fan=", 0) == 0)
+    {
+      const long long fan = std::atoll(argv[i] + 6);
+      if (fan < 1)
+      {
+        return false;
+      }
+      parsed.fan = static_cast<std::size_t>(fan);
+    }
+    else if (argument.rfind("--items=", 0) == 0)
+    {
+      parsed.items = std::atoll(argv[i] + 8);
+      if (parsed.items < 1)
+      {
+        return false;
+      }
+    }
+    else if (argument == "--format=json")
+    {
+      parsed.json = true;
+    }
+    else if (argument != "--format=csv")
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  options parsed;
+
+  if (!parse_options(argc, argv, parsed))
+  {
+    std::fprintf(stderr,
+                 "usage: %s [--topology=spsc|fanout|fanin|all] [--fan=N] "
+                 "[--items=N] [--format=csv|json]\n",
+                 argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const bool runs_fanin =
+      std::find(parsed.topologies.begin(), parsed.topologies.end(),
+                topology::fanin) != parsed.topologies.end();
+  if (runs_fanin && parsed.items < static_cast<int64_t>(parsed.fan))
+  {
+    std::fprintf(stderr,
+                 "%s: fanin splits --items=%lld between --fan=%zu writers, "
+                 "so --items must be at least --fan\n",
+                 argv[0], static_cast<long long>(parsed.items), parsed.fan);
+    return EXIT_FAILURE;
+  }
+
+  const std::vector<curve> curves = run_sweeps(parsed);
+
+  if (parsed.json)
+  {
+    print_json(curves);
+  }
+  else
+  {
+    print_csv(curves);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+// Memory footprint of disruptor_queue by capacity and payload size. Each
+// configuration is constructed once in freshly mapped memory that nothing has
+// touched, and its run reports, as counters:
+//   sizeof_bytes         sizeof the queue, of which sequence_bytes are the
+//                        slots' 64-byte padded sequences
+//   resident_bytes       pages of that mapping resident after construction,
+//                        which value-initializes every slot, so the whole
+//                        queue is faulted in before the first event
+//   construct_minflt     page faults while constructing it
+//   construct_majflt
+//   lines_per_event_estimate
+//                        computed, not measured: the payload's share of cache
+//                        lines, the slot's sequence line (which holds any
+//                        instrumentation stamp) and the claim cursor and
+//                        reader sequence lines
+// and then times laps of capacity events on one thread. Measured cache
+// traffic per event comes from the l1d_misses_per_item and
+// llc_misses_per_item counters of bench::perf_counters, where the machine
+// provides them
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "benchmark_utils.hpp"
+#include "disruptor_queue.hpp"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+constexpr std::size_t kCacheLineBytes = 64;
+// The slot's sequence, the claim cursor and the reader's sequence
+constexpr double kCursorLinesPerEvent = 3.0;
+
+template <std::size_t BYTES>
+struct payload
+{
+  std::byte bytes[BYTES];
+};
+
+struct page_faults
+{
+  int64_t minor;
+  int64_t major;
+};
+
+page_faults current_page_faults()
+{
+#ifdef __linux__
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return {usage.ru_minflt, usage.ru_majflt};
+#else
+  return {0, 0};
+#endif
+}
+
+struct footprint
+{
+  int64_t resident_bytes;
+  page_faults construct_faults;
+};
+
+// Constructs a QUEUE in a private anonymous mapping, so that every page it
+// touches faults and shows up in mincore, rather than reusing memory the
+// allocator already holds. Huge pages are disabled to count base pages
+template <typename QUEUE>
+footprint measure_construction()
+{
+#ifdef __linux__
+  const auto page_bytes = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const std::size_t bytes =
+      (sizeof(QUEUE) + page_bytes - 1) / page_bytes * page_bytes;
+
+  void* const region = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (region == MAP_FAILED)
+  {
+    return {0, {0, 0}};
+  }
+  madvise(region, bytes, MADV_NOHUGEPAGE);
+
+  const page_faults before = current_page_faults();
+  QUEUE* const queue = new (region) QUEUE();
+  const page_faults after = current_page_faults();
+
+  std::vector<unsigned char> residency(bytes / page_bytes);
+  int64_t resident_pages = 0;
+  if (mincore(region, bytes, residency.data()) == 0)
+  {
+    for (const unsigned char page : residency)
+    {
+      resident_pages += page & 1;
+    }
+  }
+
+  queue->~QUEUE();
+  munmap(region, bytes);
+
+  return {resident_pages * static_cast<int64_t>(page_bytes),
+          {after.minor - before.minor, after.major - before.major}};
+#else
+  return {0, {0, 0}};
+#endif
+}
+
+template <std::size_t CAPACITY, std::size_t BYTES>
+void BM_MemoryFootprint(benchmark::State& state)
+{
+  using queue_type = dq::disruptor_queue<payload<BYTES>, CAPACITY>;
+
+  // Google Benchmark calls this several times per configuration, so the
+  // footprint is measured on the first call only
+  static const footprint measured = measure_construction<queue_type>();
+
+  auto queue = std::make_unique<queue_type>();
+  auto& writer = queue->create_writer();
+  auto& reader = queue->create_reader();
+  queue->start();
+
+  const auto lap = [&]() {
+    for (std::size_t i = 0; i < CAPACITY; ++i)
+    {
+      writer.write(payload<BYTES>{});
+      benchmark::DoNotOptimize(reader.read());
+    }
+  };
+
+  lap();
+
+  dq::bench::throughput_meter meter;
+  for (auto _ : state)
+  {
+    meter.start();
+    lap();
+    meter.stop(state);
+  }
+
+  meter.report(state, static_cast<int64_t>(CAPACITY));
+
+  // Payloads smaller than a line share it with their neighbours
+  const double payload_lines =
+      BYTES < kCacheLineBytes
+          ? static_cast<double>(BYTES) / static_cast<double>(kCacheLineBytes)
+          : static_cast<double>((BYTES + kCacheLineBytes - 1) /
+                                kCacheLineBytes);
+
+  state.counters["sizeof_bytes"] = static_cast<double>(sizeof(queue_type));
+  state.counters["sequence_bytes"] =
+      static_cast<double>(CAPACITY * kCacheLineBytes);
+  state.counters["resident_bytes"] =
+      static_cast<double>(measured.resident_bytes);
+  state.counters["construct_minflt"] =
+      static_cast<double>(measured.construct_faults.minor);
+  state.counters["construct_majflt"] =
+      static_cast<double>(measured.construct_faults.major);
+  state.counters["lines_per_event_estimate"] =
+      payload_lines + kCursorLinesPerEvent;
+}
+
+BENCHMARK(BM_MemoryFootprint<64, 8>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MemoryFootprint<64, 64>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MemoryFootprint<64, 512>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MemoryFootprint<1024, 8>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MemoryFootprint<1024, 64>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MemoryFootprint<1024, 512>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MemoryFootprint<16384, 8>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MemoryFootprint<16384, 64>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MemoryFootprint<16384, 512>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MemoryFootprint<262144, 8>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MemoryFootprint<262144, 64>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+BENCHMARK(BM_MemoryFootprint<262144, 512>)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+
+}  // namespace
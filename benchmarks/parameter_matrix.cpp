@@ -0,0 +1,187 @@
+// Throughput over a matrix of capacity, payload size, reader count and writer
+// count, to pick the best configuration for a queue. Results go to
+// parameter_matrix.json (Google Benchmark's JSON format) unless
+// --benchmark_out says otherwise; plot_parameter_matrix.py renders them as
+// heatmaps.
+//
+// Every reader sees every event and items count events published. Capacity
+// and payload pairs whose ring would exceed kMaxQueueBytes are not
+// registered
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "benchmark_utils.hpp"
+#include "disruptor_queue.hpp"
+
+namespace
+{
+
+constexpr std::size_t kCapacities[] = {64,    256,    1024,   4096,
+                                       16384, 65536, 262144, 1048576};
+constexpr std::size_t kPayloadBytes[] = {8, 64, 512, 4096};
+constexpr int64_t kThreadCounts[] = {1, 2, 4};
+
+// Payload slots plus one 64-byte sequence per slot
+constexpr std::size_t kSequenceBytes = 64;
+constexpr std::size_t kMaxQueueBytes = std::size_t{128} << 20;
+
+constexpr int64_t kItemsPerIteration = 1 << 16;
+
+template <std::size_t BYTES>
+struct payload
+{
+  std::byte bytes[BYTES];
+};
+
+template <std::size_t CAPACITY, std::size_t BYTES>
+void BM_ParameterMatrix(benchmark::State& state)
+{
+  using queue_type = dq::disruptor_queue<payload<BYTES>, CAPACITY>;
+
+  const auto reader_count = static_cast<std::size_t>(state.range(0));
+  const auto writer_count = static_cast<std::size_t>(state.range(1));
+  const std::size_t threads = reader_count + writer_count;
+  const int64_t items_per_writer =
+      kItemsPerIteration / static_cast<int64_t>(writer_count);
+  const int64_t items = items_per_writer * static_cast<int64_t>(writer_count);
+
+  // The benchmark's thread is the first writer
+  const auto placement = dq::bench::place_benchmark_thread(0, threads, state);
+
+  auto queue = std::make_unique<queue_type>();
+
+  std::vector<typename queue_type::writer*> writers;
+  for (std::size_t i = 0; i < writer_count; ++i)
+  {
+    writers.push_back(&queue->create_writer());
+  }
+
+  std::vector<typename queue_type::reader*> readers;
+  for (std::size_t i = 0; i < reader_count; ++i)
+  {
+    readers.push_back(&queue->create_reader());
+  }
+  queue->start();
+
+  dq::bench::throughput_meter meter;
+  dq::bench::persistent_workers workers(
+      threads - 1, 1, threads, [&](const std::size_t worker) {
+        if (worker + 1 < writer_count)
+        {
+          for (int64_t i = 0; i < items_per_writer; ++i)
+          {
+            writers[worker + 1]->write(payload<BYTES>{});
+          }
+          return;
+        }
+
+        auto& reader = *readers[worker + 1 - writer_count];
+        for (int64_t i = 0; i < items; ++i)
+        {
+          benchmark::DoNotOptimize(reader.read());
+        }
+      });
+
+  for (auto _ : state)
+  {
+    meter.start();
+    workers.begin_round();
+
+    for (int64_t i = 0; i < items_per_writer; ++i)
+    {
+      writers[0]->write(payload<BYTES>{});
+    }
+
+    workers.end_round();
+    meter.stop(state);
+  }
+
+  meter.report(state, items);
+  state.counters["capacity"] = static_cast<double>(CAPACITY);
+  state.counters["payload_bytes"] = static_cast<double>(BYTES);
+  state.counters["readers"] = static_cast<double>(reader_count);
+  state.counters["writers"] = static_cast<double>(writer_count);
+}
+
+template <std::size_t CAPACITY, std::size_t BYTES>
+void register_configuration()
+{
+  if constexpr (CAPACITY * (BYTES + kSequenceBytes) <= kMaxQueueBytes)
+  {
+    const std::string name = "BM_ParameterMatrix/capacity:" +
+                             std::to_string(CAPACITY) +
+                             "/payload:" + std::to_string(BYTES);
+
+    auto* registered = benchmark::RegisterBenchmark(
+        name.c_str(), BM_ParameterMatrix<CAPACITY, BYTES>);
+    registered->ArgNames({"readers", "writers"});
+
+    for (const int64_t readers : kThreadCounts)
+    {
+      for (const int64_t writers : kThreadCounts)
+      {
+        registered->Args({readers, writers});
+      }
+    }
+
+    registered->Unit(benchmark::kMicrosecond)->UseManualTime();
+  }
+}
+
+template <std::size_t CAPACITY, std::size_t... PAYLOADS>
+void register_capacity(std::index_sequence<PAYLOADS...>)
+{
+  (register_configuration<CAPACITY, kPayloadBytes[PAYLOADS]>(), ...);
+}
+
+template <std::size_t... CAPACITIES>
+void register_matrix(std::index_sequence<CAPACITIES...>)
+{
+  (register_capacity<kCapacities[CAPACITIES]>(
+       std::make_index_sequence<std::size(kPayloadBytes)>{}),
+   ...);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<char*> arguments(argv, argv + argc);
+  bool has_output = false;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    has_output = has_output ||
+                 std::string_view(argv[i]).rfind("--benchmark_out=", 0) == 0;
+  }
+
+  std::string output = "--benchmark_out=parameter_matrix.json";
+  std::string format = "--benchmark_out_format=json";
+  if (!has_output)
+  {
+    arguments.push_back(output.data());
+    arguments.push_back(format.data());
+  }
+
+  int argument_count = static_cast<int>(arguments.size());
+  benchmark::Initialize(&argument_count, arguments.data());
+  if (benchmark::ReportUnrecognizedArguments(argument_count, arguments.data()))
+  {
+    return 1;
+  }
+
+  register_matrix(std::make_index_sequence<std::size(kCapacities)>{});
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  return 0;
+}
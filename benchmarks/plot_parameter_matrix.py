@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Renders parameter_matrix results as heatmaps.
+
+usage: plot_parameter_matrix.py [parameter_matrix.json] [--metric NAME]
+                                [--output DIR]
+
+Draws one heatmap of capacity against payload size per reader and writer
+count, shaded by the metric (items_per_second by default), and prints the
+best capacity for each payload size. Needs matplotlib.
+"""
+
+import argparse
+import collections
+import json
+import math
+import os
+import sys
+
+import matplotlib
+
+matplotlib.use("Agg")
+import matplotlib.pyplot as plt  # noqa: E402
+
+# Metrics for which lower is better
+LOWER_IS_BETTER = {"ns_per_item", "cycles_per_item", "real_time", "cpu_time"}
+
+
+def load_results(path, metric):
+    with open(path) as results_file:
+        results = json.load(results_file)
+
+    # (readers, writers) -> (capacity, payload) -> value
+    grids = collections.defaultdict(dict)
+    for run in results["benchmarks"]:
+        if run.get("run_type") == "aggregate" or "error_occurred" in run:
+            continue
+        if metric not in run:
+            sys.exit("metric %s not found in %s" % (metric, run["name"]))
+
+        threads = (int(run["readers"]), int(run["writers"]))
+        configuration = (int(run["capacity"]), int(run["payload_bytes"]))
+        grids[threads][configuration] = run[metric]
+
+    return grids
+
+
+def plot(grids, metric, output):
+    os.makedirs(output, exist_ok=True)
+    lower_is_better = metric in LOWER_IS_BETTER
+
+    for (readers, writers), grid in sorted(grids.items()):
+        capacities = sorted({capacity for capacity, _ in grid})
+        payloads = sorted({payload for _, payload in grid})
+        values = [[grid.get((capacity, payload), math.nan)
+                   for payload in payloads] for capacity in capacities]
+
+        figure, axes = plt.subplots(figsize=(1.6 * len(payloads) + 2,
+                                             0.5 * len(capacities) + 2))
+        image = axes.imshow(values, aspect="auto",
+                            cmap="viridis_r" if lower_is_better
+                            else "viridis")
+        axes.set_xticks(range(len(payloads)), [str(p) for p in payloads])
+        axes.set_yticks(range(len(capacities)), [str(c) for c in capacities])
+        axes.set_xlabel("payload bytes")
+        axes.set_ylabel("capacity")
+        axes.set_title("%s, %d reader(s), %d writer(s)"
+                       % (metric, readers, writers))
+
+        for row, capacity_values in enumerate(values):
+            for column, value in enumerate(capacity_values):
+                if not math.isnan(value):
+                    axes.text(column, row, "%.3g" % value, ha="center",
+                              va="center", fontsize=7, color="white")
+
+        figure.colorbar(image, ax=axes, label=metric)
+        figure.tight_layout()
+        path = os.path.join(output, "parameter_matrix_r%d_w%d.png"
+                            % (readers, writers))
+        figure.savefig(path, dpi=120)
+        plt.close(figure)
+        print("wrote %s" % path)
+
+        for payload in payloads:
+            candidates = [(grid[(capacity, payload)], capacity)
+                          for capacity in capacities
+                          if (capacity, payload) in grid]
+            value, capacity = (min if lower_is_better else max)(candidates)
+            print("  readers=%d writers=%d payload=%d: best capacity %d "
+                  "(%s %.4g)" % (readers, writers, payload, capacity, metric,
+                                 value))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("results", nargs="?", default="parameter_matrix.json")
+    parser.add_argument("--metric", default="items_per_second")
+    parser.add_argument("--output", default="parameter_matrix_plots")
+    arguments = parser.parse_args()
+
+    grids = load_results(arguments.results, arguments.metric)
+    if not grids:
+        sys.exit("no parameter_matrix results in %s" % arguments.results)
+
+    plot(grids, arguments.metric, arguments.output)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,172 @@
+// Microbenchmarks of the steps a write and a read are made of, reached through
+// internal::queue_access, so that a regression in one step shows up on its own
+// rather than as a small change in end-to-end throughput
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark_utils.hpp"
+#include "disruptor_queue.hpp"
+#include "queue_access.hpp"
+
+namespace
+{
+
+using queue_type = dq::disruptor_queue<int64_t, 1024>;
+using access = dq::internal::queue_access;
+
+constexpr int kMaxClaimThreads = 8;
+
+// Without readers a claim never waits for space, so these measure taking a
+// sequence and the writer's capacity check alone
+void BM_ClaimSequence_Uncontended(benchmark::State& state)
+{
+  const auto policy = static_cast<dq::backpressure_policy>(state.range(0));
+
+  auto queue = std::make_unique<queue_type>();
+  auto& writer = queue->create_writer(policy);
+  queue->start();
+
+  int64_t claimed = 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(access::claim_sequence(writer, claimed));
+    benchmark::DoNotOptimize(claimed);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// One queue per policy shared by the benchmark's threads, each claiming
+// through its own writer
+queue_type::writer& shared_claim_writer(const dq::backpressure_policy policy,
+                                        const int thread)
+{
+  struct shared_queue
+  {
+    std::unique_ptr<queue_type> queue = std::make_unique<queue_type>();
+    std::vector<queue_type::writer*> writers{};
+
+    explicit shared_queue(const dq::backpressure_policy policy)
+    {
+      for (int i = 0; i < kMaxClaimThreads; ++i)
+      {
+        writers.push_back(&queue->create_writer(policy));
+      }
+      queue->start();
+    }
+  };
+
+  static shared_queue block(dq::backpressure_policy::block);
+  static shared_queue fail(dq::backpressure_policy::fail);
+
+  return policy == dq::backpressure_policy::block ? *block.writers[thread]
+                                                  : *fail.writers[thread];
+}
+
+// block claims with a fetch_add, fail with a compare-exchange that retries
+// when another writer got there first
+void BM_ClaimSequence_Contended(benchmark::State& state)
+{
+  const auto policy = static_cast<dq::backpressure_policy>(state.range(0));
+  const auto placement = dq::bench::place_benchmark_thread(
+      state.thread_index(), state.threads(), state);
+
+  auto& writer = shared_claim_writer(policy, state.thread_index());
+
+  int64_t claimed = 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(access::claim_sequence(writer, claimed));
+    benchmark::DoNotOptimize(claimed);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Stamps and publishes a slot's sequence, without claiming it or copying a
+// value in
+void BM_CommitSequence(benchmark::State& state)
+{
+  auto queue = std::make_unique<queue_type>();
+  auto& writer = queue->create_writer();
+  queue->start();
+
+  int64_t sequence = 0;
+  for (auto _ : state)
+  {
+    access::commit_sequence(writer, sequence++);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// The scan writers make of every reader's sequence when their cached minimum
+// runs out
+void BM_MinConsumerSequence(benchmark::State& state)
+{
+  const int64_t reader_count = state.range(0);
+
+  auto queue = std::make_unique<queue_type>();
+  static_cast<void>(queue->create_writer());
+  for (int64_t i = 0; i < reader_count; ++i)
+  {
+    static_cast<void>(queue->create_reader());
+  }
+  queue->start();
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(access::min_consumer_sequence(*queue));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["time_per_reader"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * reader_count),
+      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+// A reader finding its sequence already published, as it does whenever it is
+// behind the writers
+void BM_WaitForData_Hit(benchmark::State& state)
+{
+  auto queue = std::make_unique<queue_type>();
+  auto& writer = queue->create_writer();
+  auto& reader = queue->create_reader();
+  queue->start();
+
+  writer.write(0);
+  const int64_t sequence = access::next_read_sequence(reader);
+
+  for (auto _ : state)
+  {
+    access::wait_for_data(reader, sequence);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ClaimSequence_Uncontended)
+    ->ArgName("policy")
+    ->Arg(static_cast<int64_t>(dq::backpressure_policy::block))
+    ->Arg(static_cast<int64_t>(dq::backpressure_policy::fail))
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_ClaimSequence_Contended)
+    ->ArgName("policy")
+    ->Arg(static_cast<int64_t>(dq::backpressure_policy::block))
+    ->Arg(static_cast<int64_t>(dq::backpressure_policy::fail))
+    ->ThreadRange(2, kMaxClaimThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_CommitSequence)->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_MinConsumerSequence)
+    ->ArgName("readers")
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_WaitForData_Hit)->Unit(benchmark::kNanosecond);
+
+}  // namespace
@@ -0,0 +1,605 @@
+// Replays a recorded arrival trace into a queue and reports latency and
+// backlog over time, to benchmark against production bursts offline.
+//
+// usage: trace_replay --trace=PATH [--speed=X] [--window-ms=N]
+//                     [--wait=busy_spin|adaptive] [--format=csv|json]
+//        trace_replay --generate=PATH [--records=N] [--producers=N]
+//
+// A trace is a trace_header followed by trace_records, in host byte order.
+// Each record is published by its producer's writer at the recorded time
+// since the start, divided by --speed, and its latency runs from that time
+// to its consumption by a single reader. Payloads are copied into the event,
+// up to kMaxPayloadBytes. Backlog is the number of events due by the time of
+// a read that have not been read yet, wherever they wait.
+//
+// The timeline has one row per window: events due in it, events read in it,
+// their mean and maximum latency and the largest backlog seen. The summary
+// goes to stderr for CSV. --generate writes a synthetic bursty trace
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "disruptor_queue.hpp"
+#include "latency_histogram.hpp"
+#include "tsc_clock.hpp"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+constexpr char kTraceMagic[8] = {'D', 'Q', 'T', 'R', 'A', 'C', 'E', '\0'};
+constexpr uint32_t kTraceVersion = 1;
+
+struct trace_header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t record_count;
+};
+
+struct trace_record
+{
+  // Time since the previous record in the trace, across all producers
+  uint64_t interarrival_ns;
+  uint32_t payload_bytes;
+  uint32_t producer;
+};
+
+static_assert(sizeof(trace_header) == 24, "Trace header layout changed");
+static_assert(sizeof(trace_record) == 16, "Trace record layout changed");
+
+constexpr std::size_t kMaxProducers = 64;
+constexpr std::size_t kMaxPayloadBytes = 256;
+constexpr std::size_t kQueueCapacity = 4096;
+
+// Lets every thread reach its spin loop before the first record is due
+constexpr double kStartDelayNs = 5e6;
+
+struct trace_event
+{
+  uint64_t intended;
+  uint32_t payload_bytes;
+  uint32_t producer;
+  std::byte payload[kMaxPayloadBytes];
+};
+
+// A read-only mapping of a trace file
+class mapped_trace
+{
+ public:
+  explicit mapped_trace(const char* path);
+  ~mapped_trace();
+
+  mapped_trace(const mapped_trace&) = delete;
+  mapped_trace& operator=(const mapped_trace&) = delete;
+
+  [[nodiscard]] bool valid() const noexcept;
+  [[nodiscard]] const trace_record* records() const noexcept;
+  [[nodiscard]] std::size_t size() const noexcept;
+
+ private:
+  void* _mapping{nullptr};
+  std::size_t _mapping_bytes{0};
+  std::size_t _size{0};
+};
+
+mapped_trace::mapped_trace(const char* path)
+{
+#ifdef __linux__
+  const int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    return;
+  }
+
+  struct stat status{};
+  if (fstat(fd, &status) == 0 &&
+      static_cast<std::size_t>(status.st_size) >= sizeof(trace_header))
+  {
+    _mapping_bytes = static_cast<std::size_t>(status.st_size);
+    _mapping = mmap(nullptr, _mapping_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (_mapping == MAP_FAILED)
+    {
+      _mapping = nullptr;
+    }
+  }
+  close(fd);
+
+  if (_mapping == nullptr)
+  {
+    return;
+  }
+
+  madvise(_mapping, _mapping_bytes, MADV_SEQUENTIAL);
+
+  const auto* const header = static_cast<const trace_header*>(_mapping);
+  const std::size_t available =
+      (_mapping_bytes - sizeof(trace_header)) / sizeof(trace_record);
+
+  if (std::memcmp(header->magic, kTraceMagic, sizeof(kTraceMagic)) == 0 &&
+      header->version == kTraceVersion &&
+      header->record_size == sizeof(trace_record) &&
+      header->record_count <= available)
+  {
+    _size = static_cast<std::size_t>(header->record_count);
+  }
+  else
+  {
+    munmap(_mapping, _mapping_bytes);
+    _mapping = nullptr;
+  }
+#else
+  static_cast<void>(path);
+#endif
+}
+
+mapped_trace::~mapped_trace()
+{
+#ifdef __linux__
+  if (_mapping != nullptr)
+  {
+    munmap(_mapping, _mapping_bytes);
+  }
+#endif
+}
+
+bool mapped_trace::valid() const noexcept
+{
+  return _mapping != nullptr;
+}
+
+const trace_record* mapped_trace::records() const noexcept
+{
+  return reinterpret_cast<const trace_record*>(
+      static_cast<const std::byte*>(_mapping) + sizeof(trace_header));
+}
+
+std::size_t mapped_trace::size() const noexcept
+{
+  return _size;
+}
+
+struct options
+{
+  std::string trace;
+  std::string generate;
+  double speed = 1.0;
+  int64_t window_ms = 10;
+  bool adaptive = false;
+  bool json = false;
+  int64_t records = 1000000;
+  int64_t producers = 2;
+};
+
+struct window
+{
+  int64_t due = 0;
+  int64_t consumed = 0;
+  double latency_sum_ns = 0.0;
+  double max_latency_ns = 0.0;
+  int64_t max_backlog = 0;
+};
+
+struct replay_result
+{
+  std::vector<window> timeline;
+  dq::histogram_snapshot latency;
+  double elapsed_ns;
+  int64_t max_backlog;
+};
+
+// Schedules records in tsc_clock ticks from the start of the replay
+class schedule
+{
+ public:
+  schedule(const trace_record* records, const double ticks_per_trace_ns)
+      : _records{records}, _ticks_per_trace_ns{ticks_per_trace_ns}
+  {
+  }
+
+  // Due time of the next record; records must be visited in order
+  uint64_t next(const std::size_t index) noexcept
+  {
+    _elapsed_ns += static_cast<double>(_records[index].interarrival_ns);
+    return static_cast<uint64_t>(_elapsed_ns * _ticks_per_trace_ns);
+  }
+
+ private:
+  const trace_record* const _records;
+  const double _ticks_per_trace_ns;
+  double _elapsed_ns{0.0};
+};
+
+template <typename WAIT_STRATEGY>
+replay_result replay(const mapped_trace& trace, const options& parsed)
+{
+  using queue_type =
+      dq::disruptor_queue<trace_event, kQueueCapacity, WAIT_STRATEGY>;
+
+  const trace_record* const records = trace.records();
+  const std::size_t count = trace.size();
+
+  std::size_t producers = 1;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    producers = std::max<std::size_t>(producers, records[i].producer + 1);
+  }
+
+  auto queue = std::make_unique<queue_type>();
+  std::vector<typename queue_type::writer*> writers;
+  for (std::size_t i = 0; i < producers; ++i)
+  {
+    writers.push_back(&queue->create_writer());
+  }
+  auto& reader = queue->create_reader();
+  queue->start();
+
+  const double ns_per_tick = dq::tsc_clock::to_nanoseconds(1);
+  const double ticks_per_trace_ns = 1.0 / (parsed.speed * ns_per_tick);
+  const auto window_ticks = static_cast<uint64_t>(
+      static_cast<double>(parsed.window_ms) * 1e6 / ns_per_tick);
+
+  std::barrier ready(static_cast<std::ptrdiff_t>(producers + 2));
+  std::atomic<uint64_t> origin{0};
+  std::vector<std::thread> threads;
+
+  for (std::size_t producer = 0; producer < producers; ++producer)
+  {
+    threads.emplace_back([&, producer]() {
+      ready.arrive_and_wait();
+      const uint64_t start = origin.load(std::memory_order_acquire);
+      schedule due(records, ticks_per_trace_ns);
+
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        const uint64_t intended = start + due.next(i);
+        if (records[i].producer != producer)
+        {
+          continue;
+        }
+
+        trace_event event;
+        event.intended = intended;
+        event.payload_bytes = records[i].payload_bytes;
+        event.producer = records[i].producer;
+        std::memset(event.payload, static_cast<int>(i),
+                    std::min<std::size_t>(event.payload_bytes,
+                                          kMaxPayloadBytes));
+
+        while (dq::tsc_clock::now() < intended)
+        {
+        }
+        writers[producer]->write(event);
+      }
+    });
+  }
+
+  replay_result result{};
+  dq::latency_histogram latency;
+  uint64_t finish = 0;
+
+  threads.emplace_back([&]() {
+    ready.arrive_and_wait();
+    const uint64_t start = origin.load(std::memory_order_acquire);
+    schedule due(records, ticks_per_trace_ns);
+
+    const auto window_of = [&](const uint64_t ticks) -> window& {
+      const auto index =
+          static_cast<std::size_t>((ticks - std::min(ticks, start)) /
+                                   window_ticks);
+      if (index >= result.timeline.size())
+      {
+        result.timeline.resize(index + 1);
+      }
+      return result.timeline[index];
+    };
+
+    std::size_t arrived = 0;
+    uint64_t next_due = count > 0 ? start + due.next(0) : 0;
+
+    for (std::size_t consumed = 1; consumed <= count; ++consumed)
+    {
+      const trace_event event = reader.read();
+      const uint64_t now = dq::tsc_clock::now();
+      const uint64_t waited = now > event.intended ? now - event.intended : 0;
+      latency.record(waited);
+
+      while (arrived < count && next_due <= now)
+      {
+        ++window_of(next_due).due;
+        ++arrived;
+        next_due = arrived < count ? start + due.next(arrived) : next_due;
+      }
+
+      const auto backlog = static_cast<int64_t>(arrived - consumed);
+      const double waited_ns = dq::tsc_clock::to_nanoseconds(waited);
+
+      window& current = window_of(now);
+      ++current.consumed;
+      current.latency_sum_ns += waited_ns;
+      current.max_latency_ns = std::max(current.max_latency_ns, waited_ns);
+      current.max_backlog = std::max(current.max_backlog, backlog);
+      result.max_backlog = std::max(result.max_backlog, backlog);
+    }
+
+    finish = dq::tsc_clock::now();
+  });
+
+  origin.store(dq::tsc_clock::now() +
+                   static_cast<uint64_t>(kStartDelayNs / ns_per_tick),
+               std::memory_order_release);
+  ready.arrive_and_wait();
+
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+
+  result.latency = latency.snapshot();
+  result.elapsed_ns =
+      dq::tsc_clock::to_nanoseconds(finish - std::min(finish, origin.load()));
+  return result;
+}
+
+// Bursts of 10 to 1000 records 100 ns apart, separated by 0.1 to 2 ms of
+// silence, from random producers with payloads of 16 to 256 bytes
+bool generate_trace(const options& parsed)
+{
+  std::FILE* const file = std::fopen(parsed.generate.c_str(), "wb");
+  if (file == nullptr)
+  {
+    return false;
+  }
+
+  trace_header header{};
+  std::memcpy(header.magic, kTraceMagic, sizeof(kTraceMagic));
+  header.version = kTraceVersion;
+  header.record_size = sizeof(trace_record);
+  header.record_count = static_cast<uint64_t>(parsed.records);
+  bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+  uint64_t state = 0x9e3779b97f4a7c15ULL;
+  const auto random = [&state](const uint64_t bound) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (state >> 33) % bound;
+  };
+
+  int64_t burst_left = 0;
+  for (int64_t i = 0; i < parsed.records && written; ++i)
+  {
+    trace_record record{};
+    if (burst_left == 0)
+    {
+      burst_left = 10 + static_cast<int64_t>(random(991));
+      record.interarrival_ns = 100000 + random(1900001);
+    }
+    else
+    {
+      record.interarrival_ns = 100;
+    }
+    --burst_left;
+
+    record.payload_bytes = static_cast<uint32_t>(16 + random(241));
+    record.producer =
+        static_cast<uint32_t>(random(static_cast<uint64_t>(parsed.producers)));
+    written = std::fwrite(&record, sizeof(record), 1, file) == 1;
+  }
+
+  return std::fclose(file) == 0 && written;
+}
+
+double ns(const uint64_t ticks)
+{
+  return dq::tsc_clock::to_nanoseconds(ticks);
+}
+
+void print_summary(std::FILE* const out, const replay_result& result,
+                   const std::size_t records)
+{
+  std::fprintf(out,
+               "{\"records\":%zu,\"elapsed_ms\":%.3f,\"p50_ns\":%.0f,"
+               "\"p99_ns\":%.0f,\"p99.9_ns\":%.0f,\"p99.99_ns\":%.0f,"
+               "\"max_ns\":%.0f,\"max_backlog\":%lld}",
+               records, result.elapsed_ns / 1e6,
+               ns(result.latency.value_at_percentile(50.0)),
+               ns(result.latency.value_at_percentile(99.0)),
+               ns(result.latency.value_at_percentile(99.9)),
+               ns(result.latency.value_at_percentile(99.99)),
+               ns(result.latency.max()),
+               static_cast<long long>(result.max_backlog));
+}
+
+void print_csv(const replay_result& result, const options& parsed,
+               const std::size_t records)
+{
+  std::printf(
+      "window_start_ms,due,consumed,mean_latency_ns,max_latency_ns,"
+      "max_backlog\n");
+
+  for (std::size_t i = 0; i < result.timeline.size(); ++i)
+  {
+    const window& row = result.timeline[i];
+    std::printf("%lld,%lld,%lld,%.0f,%.0f,%lld\n",
+                static_cast<long long>(static_cast<int64_t>(i) *
+                                       parsed.window_ms),
+                static_cast<long long>(row.due),
+                static_cast<long long>(row.consumed),
+                row.consumed > 0
+                    ? row.latency_sum_ns / static_cast<double>(row.consumed)
+                    : 0.0,
+                row.max_latency_ns, static_cast<long long>(row.max_backlog));
+  }
+
+  print_summary(stderr, result, records);
+  std::fprintf(stderr, "\n");
+}
+
+void print_json(const replay_result& result, const options& parsed,
+                const std::size_t records)
+{
+  std::printf("{\"summary\":");
+  print_summary(stdout, result, records);
+  std::printf(",\"window_ms\":%lld,\"timeline\":[",
+              static_cast<long long>(parsed.window_ms));
+
+  for (std::size_t i = 0; i < result.timeline.size(); ++i)
+  {
+    const window& row = result.timeline[i];
+    std::printf(
+        "%s\n{\"due\":%lld,\"consumed\":%lld,\"mean_latency_ns\":%.0f,"
+        "\"max_latency_ns\":%.0f,\"max_backlog\":%lld}",
+        i == 0 ? "" : ",", static_cast<long long>(row.due),
+        static_cast<long long>(row.consumed),
+        row.consumed > 0
+            ? row.latency_sum_ns / static_cast<double>(row.consumed)
+            : 0.0,
+        row.max_latency_ns, static_cast<long long>(row.max_backlog));
+  }
+
+  std::printf("\n]}\n");
+}
+
+bool parse_options(int argc, char** argv, options& parsed)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string_view argument = argv[i];
+
+    if (argument.rfind("--trace=", 0) == 0)
+    {
+      parsed.trace = argument.substr(8);
+    }
+    else if (argument.rfind("--generate=", 0) == 0)
+    {
+      parsed.generate = argument.substr(11);
+    }
+    else if (argument.rfind("--speed=", 0) == 0)
+    {
+      parsed.speed = std::atof(argv[i] + 8);
+      if (!(parsed.speed > 0.0))
+      {
+        return false;
+      }
+    }
+    else if (argument.rfind("--window-ms=", 0) == 0)
+    {
+      parsed.window_ms = std::atoll(argv[i] + 12);
+      if (parsed.window_ms < 1)
+      {
+        return false;
+      }
+    }
+    else if (argument.rfind("--records=", 0) == 0)
+    {
+      parsed.records = std::atoll(argv[i] + 10);
+      if (parsed.records < 1)
+      {
+        return false;
+      }
+    }
+    else if (argument.rfind("--producers=", 0) == 0)
+    {
+      parsed.producers = std::atoll(argv[i] + 12);
+      if (parsed.producers < 1 ||
+          parsed.producers > static_cast<int64_t>(kMaxProducers))
+      {
+        return false;
+      }
+    }
+    else if (argument == "--wait=adaptive")
+    {
+      parsed.adaptive = true;
+    }
+    else if (argument == "--format=json")
+    {
+      parsed.json = true;
+    }
+    else if (argument != "--wait=busy_spin" && argument != "--format=csv")
+    {
+      return false;
+    }
+  }
+
+  return parsed.trace.empty() != parsed.generate.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  options parsed;
+
+  if (!parse_options(argc, argv, parsed))
+  {
+    std::fprintf(stderr,
+                 "usage: %s --trace=PATH [--speed=X] [--window-ms=N] "
+                 "[--wait=busy_spin|adaptive] [--format=csv|json]\n"
+                 "       %s --generate=PATH [--records=N] [--producers=N]\n",
+                 argv[0], argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (!parsed.generate.empty())
+  {
+    if (!generate_trace(parsed))
+    {
+      std::fprintf(stderr, "%s: cannot write %s\n", argv[0],
+                   parsed.generate.c_str());
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  const mapped_trace trace(parsed.trace.c_str());
+  if (!trace.valid())
+  {
+    std::fprintf(stderr, "%s: %s is not a readable trace\n", argv[0],
+                 parsed.trace.c_str());
+    return EXIT_FAILURE;
+  }
+
+  for (std::size_t i = 0; i < trace.size(); ++i)
+  {
+    if (trace.records()[i].producer >= kMaxProducers)
+    {
+      std::fprintf(stderr, "%s: record %zu has producer %u, above %zu\n",
+                   argv[0], i, trace.records()[i].producer,
+                   kMaxProducers - 1);
+      return EXIT_FAILURE;
+    }
+  }
+
+  const replay_result result =
+      parsed.adaptive
+          ? replay<dq::adaptive_wait_strategy>(trace, parsed)
+          : replay<dq::busy_spin_wait_strategy>(trace, parsed);
+
+  if (parsed.json)
+  {
+    print_json(result, parsed, trace.size());
+  }
+  else
+  {
+    print_csv(result, parsed, trace.size());
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "tsc_clock.hpp"
+
+namespace dq
+{
+
+enum class trace_span_kind : std::uint8_t
+{
+  // A run of events a reader consumed without waiting
+  batch,
+  // A reader waiting for its next event, or a writer waiting for readers
+  wait,
+};
+
+struct trace_span
+{
+  trace_span_kind kind;
+  std::int64_t first_sequence;
+  std::int64_t last_sequence;
+  // tsc_clock ticks
+  std::uint64_t begin_ticks;
+  std::uint64_t end_ticks;
+};
+
+// Append-only span buffer owned by one thread. Other threads may read the
+// spans appended so far; once full, further spans are counted and dropped
+template <std::size_t SPANS>
+class trace_buffer
+{
+ public:
+  void append(const trace_span& span) noexcept;
+
+  [[nodiscard]] std::vector<trace_span> spans() const;
+  [[nodiscard]] std::uint64_t dropped() const noexcept;
+
+ private:
+  std::unique_ptr<trace_span[]> _spans{
+      std::make_unique_for_overwrite<trace_span[]>(SPANS)};
+  std::atomic<std::size_t> _size{0};
+  std::atomic<std::uint64_t> _dropped{0};
+};
+
+template <std::size_t SPANS>
+auto trace_buffer<SPANS>::append(const trace_span& span) noexcept -> void
+{
+  const std::size_t size = _size.load(std::memory_order_relaxed);
+
+  if (size == SPANS)
+  {
+    _dropped.store(_dropped.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+    return;
+  }
+
+  _spans[size] = span;
+  _size.store(size + 1, std::memory_order_release);
+}
+
+template <std::size_t SPANS>
+auto trace_buffer<SPANS>::spans() const -> std::vector<trace_span>
+{
+  const std::size_t size = _size.load(std::memory_order_acquire);
+  return {_spans.get(), _spans.get() + size};
+}
+
+template <std::size_t SPANS>
+auto trace_buffer<SPANS>::dropped() const noexcept -> std::uint64_t
+{
+  return _dropped.load(std::memory_order_relaxed);
+}
+
+// Records batch and wait spans on top of BASE into each reader's and writer's
+// own trace_buffer, for export with chrome_trace. Every consumed event reads
+// the clock, so this is meant for offline analysis rather than production
+template <typename BASE = no_instrumentation, std::size_t SPANS = 65536>
+struct trace_instrumentation : BASE
+{
+  struct alignas(64) writer_counters : BASE::writer_counters
+  {
+    void on_wrap_stall() noexcept
+    {
+      BASE::writer_counters::on_wrap_stall();
+      _wait_begin = tsc_clock::now();
+    }
+
+    void on_wrap_resume(std::int64_t sequence) noexcept
+    {
+      BASE::writer_counters::on_wrap_resume(sequence);
+      trace.append({trace_span_kind::wait, sequence, sequence, _wait_begin,
+                    tsc_clock::now()});
+    }
+
+    trace_buffer<SPANS> trace;
+
+   private:
+    std::uint64_t _wait_begin{0};
+  };
+
+  struct alignas(64) reader_counters : BASE::reader_counters
+  {
+    void on_wait_spin() noexcept
+    {
+      BASE::reader_counters::on_wait_spin();
+
+      if (!_waiting)
+      {
+        _waiting = true;
+        _wait_begin = tsc_clock::now();
+      }
+    }
+
+    void on_read(bool waited) noexcept
+    {
+      BASE::reader_counters::on_read(waited);
+      _waited = waited;
+    }
+
+    template <typename STAMP>
+    void on_consume(const STAMP& stamp, std::int64_t sequence) noexcept
+    {
+      BASE::reader_counters::on_consume(stamp, sequence);
+      const std::uint64_t now = tsc_clock::now();
+
+      if (_waited)
+      {
+        close_batch();
+        trace.append({trace_span_kind::wait, sequence, sequence,
+                      _waiting ? _wait_begin : now, now});
+        _waiting = false;
+      }
+
+      if (!_in_batch)
+      {
+        _in_batch = true;
+        _batch = {trace_span_kind::batch, sequence, sequence, now, now};
+      }
+
+      _batch.last_sequence = sequence;
+      _batch.end_ticks = now;
+    }
+
+    trace_buffer<SPANS> trace;
+
+   private:
+    void close_batch() noexcept
+    {
+      if (_in_batch)
+      {
+        trace.append(_batch);
+        _in_batch = false;
+      }
+    }
+
+    trace_span _batch{};
+    std::uint64_t _wait_begin{0};
+    bool _in_batch{false};
+    bool _waiting{false};
+    bool _waited{false};
+  };
+};
+
+// Collects the spans of one or more queues recorded with trace_instrumentation
+// and writes them as Chrome trace-event JSON, viewable in Perfetto or
+// chrome://tracing. Each queue is a process and each reader and writer a
+// thread. A reader's batch in progress is only exported once it next waits,
+// so add queues after their threads have stopped, or the most recent
+// activity is missing
+class chrome_trace
+{
+ public:
+  template <typename QUEUE>
+  void add_queue(const QUEUE& queue, const std::string& name);
+
+  void write(std::ostream& out) const;
+  // Returns false if the file could not be written
+  bool write_file(const std::string& path) const;
+
+ private:
+  struct thread_spans
+  {
+    std::size_t process;
+    std::size_t thread;
+    std::string name;
+    std::vector<trace_span> spans;
+  };
+
+  static void write_escaped(std::ostream& out, const std::string& text);
+
+  std::vector<std::string> _processes{};
+  std::vector<thread_spans> _threads{};
+};
+
+template <typename QUEUE>
+auto chrome_trace::add_queue(const QUEUE& queue, const std::string& name)
+    -> void
+{
+  const std::size_t process = _processes.size();
+  _processes.push_back(name);
+
+  std::size_t thread = 0;
+  std::size_t writer_index = 0;
+  std::size_t reader_index = 0;
+
+  queue.for_each_writer([&](const auto& writer) {
+    _threads.push_back({process, thread++,
+                        "writer " + std::to_string(writer_index++),
+                        writer.counters().trace.spans()});
+  });
+
+  queue.for_each_reader([&](const auto& reader) {
+    _threads.push_back({process, thread++,
+                        "reader " + std::to_string(reader_index++),
+                        reader.counters().trace.spans()});
+  });
+}
+
+inline auto chrome_trace::write(std::ostream& out) const -> void
+{
+  std::uint64_t origin = std::numeric_limits<std::uint64_t>::max();
+  for (const thread_spans& thread : _threads)
+  {
+    for (const trace_span& span : thread.spans)
+    {
+      origin = std::min(origin, span.begin_ticks);
+    }
+  }
+
+  const auto microseconds = [&](const std::uint64_t ticks) {
+    return tsc_clock::to_nanoseconds(ticks > origin ? ticks - origin : 0) /
+           1000.0;
+  };
+
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  const char* separator = "\n";
+
+  for (std::size_t process = 0; process < _processes.size(); ++process)
+  {
+    out << separator << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":"
+        << process << ",\"args\":{\"name\":";
+    write_escaped(out, _processes[process]);
+    out << "}}";
+    separator = ",\n";
+  }
+
+  for (const thread_spans& thread : _threads)
+  {
+    out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":"
+        << thread.process << ",\"tid\":" << thread.thread
+        << ",\"args\":{\"name\":";
+    write_escaped(out, thread.name);
+    out << "}}";
+
+    for (const trace_span& span : thread.spans)
+    {
+      const bool batch = span.kind == trace_span_kind::batch;
+      const double begin = microseconds(span.begin_ticks);
+
+      out << separator << "{\"name\":\"" << (batch ? "batch" : "wait")
+          << "\",\"cat\":\"dq\",\"ph\":\"X\",\"pid\":" << thread.process
+          << ",\"tid\":" << thread.thread << ",\"ts\":" << begin
+          << ",\"dur\":" << microseconds(span.end_ticks) - begin
+          << ",\"args\":{\"first_sequence\":" << span.first_sequence
+          << ",\"last_sequence\":" << span.last_sequence;
+      if (batch)
+      {
+        out << ",\"events\":" << span.last_sequence - span.first_sequence + 1;
+      }
+      out << "}}";
+    }
+  }
+
+  out << "\n]}\n";
+}
+
+inline auto chrome_trace::write_file(const std::string& path) const -> bool
+{
+  std::ofstream out(path, std::ios::trunc);
+
+  if (!out)
+  {
+    return false;
+  }
+
+  write(out);
+  return static_cast<bool>(out.flush());
+}
+
+inline auto chrome_trace::write_escaped(std::ostream& out,
+                                        const std::string& text) -> void
+{
+  static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+  out << '"';
+  for (const char c : text)
+  {
+    const auto byte = static_cast<unsigned char>(c);
+
+    switch (c)
+    {
+      case '"':
+      case '\\':
+        out << '\\' << c;
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      case '\t':
+        out << "\\t";
+        break;
+      default:
+        // JSON strings cannot hold raw control characters
+        if (byte < 0x20)
+        {
+          out << "\\u00" << HEX_DIGITS[byte >> 4] << HEX_DIGITS[byte & 0xf];
+        }
+        else
+        {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+}
+
+}  // namespace dq
@@ -3,19 +3,53 @@
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <deque>
 #include <limits>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 #include "bit_utils.hpp"
+#include "instrumentation.hpp"
+#include "queue_statistics.hpp"
+#include "usdt.hpp"
+#include "wait_strategy.hpp"
+#include "watermark.hpp"
 
 namespace dq
 {
 
-template <typename T, std::size_t CAPACITY>
+// What a writer does when the ring is full because the slowest reader has not
+// yet released the slot it needs
+enum class backpressure_policy
+{
+  // Wait for readers to free space using the queue's wait strategy, which
+  // busy-spins by default
+  block,
+  // Spin for a bounded number of attempts, then yield and finally park until
+  // a reader advances. Readers of a queue with such a writer pay a fence and
+  // a check for parked writers on every read
+  spin_then_park,
+  // Return false immediately without publishing
+  fail,
+  // Discard the new event, count it and return false without publishing
+  drop_newest,
+};
+
+namespace internal
+{
+// Reaches the queue's individual steps for tests and microbenchmarks, see
+// queue_access.hpp
+struct queue_access;
+}  // namespace internal
+
+template <typename T, std::size_t CAPACITY,
+          typename WAIT_STRATEGY = busy_spin_wait_strategy,
+          typename INSTRUMENTATION = DQ_DEFAULT_INSTRUMENTATION>
 class disruptor_queue
 {
   using sequence_type = int64_t;
@@ -43,39 +77,86 @@ class disruptor_queue
 
   // Reader/Writer creation must be called during setup ONLY
   [[nodiscard]] reader& create_reader();
-  [[nodiscard]] writer& create_writer();
+  [[nodiscard]] writer& create_writer(
+      backpressure_policy policy = backpressure_policy::block);
   void start();
 
+  // Setup only. Occupancy is the claimed cursor minus the slowest reader's
+  // sequence. Writers evaluate it when they refresh their cached minimum, at
+  // most once per high - low claims, so they may see the high watermark that
+  // many events late. Readers evaluate it only while the queue is above the
+  // high watermark and the reader that last gated it is within the low
+  // watermark of the claimed cursor. The callback runs on the monitor's own
+  // thread, see watermark_monitor
+  void set_watermarks(size_type high, size_type low,
+                      watermark_monitor::callback_type on_crossing = {},
+                      bool signal_eventfd = false);
+  [[nodiscard]] const watermark_monitor& watermarks() const noexcept;
+
+  // Safe to call from any thread once the queue has started. Only loads the
+  // sequences and counters the hot path already maintains; observers derive
+  // rates from successive snapshots with their own reader_rates
+  [[nodiscard]] queue_statistics statistics() const;
+
+  // Visits every reader/writer in creation order, for inspection tools. Safe
+  // from any thread once the queue has started
+  template <typename Visitor>
+  void for_each_reader(Visitor&& visitor) const;
+  template <typename Visitor>
+  void for_each_writer(Visitor&& visitor) const;
+
   [[nodiscard]] static constexpr size_type capacity() noexcept;
 
  private:
   static size_type index_from_sequence(sequence_type sequence) noexcept;
   sequence_type get_min_consumer_sequence() const noexcept;
+  sequence_type get_published_cursor() const noexcept;
 
   std::array<value_type, CAPACITY> _buffer{};
 
   struct alignas(64) padded_sequence
   {
     std::atomic<sequence_type> value{INITIAL_SEQUENCE};
+    [[no_unique_address]] typename INSTRUMENTATION::slot_stamp stamp{};
   };
 
+  static_assert(sizeof(padded_sequence) == 64,
+                "Instrumentation slot stamp must fit in the slot padding");
+
   std::array<padded_sequence, CAPACITY> _slot_sequences{};
 
   std::atomic<sequence_type> _next_sequence{0};
 
+  // Readers waiting for data are woken by commits, writers waiting for space
+  // by consumer sequence updates. Only touched by strategies and the
+  // spin_then_park policy, which park
+  internal::parking_lot _reader_lot;
+  internal::parking_lot _writer_lot;
+  // Whether any writer uses spin_then_park, which needs readers to wake it.
+  // Set during setup only
+  bool _has_parking_writers{false};
+
+  watermark_monitor _watermarks;
+
   std::mutex _setup_mutex;
   std::atomic<bool> _operations_started{false};
   std::deque<std::unique_ptr<reader>> _readers{};
   std::deque<std::unique_ptr<writer>> _writers{};
+
+  friend struct internal::queue_access;
 };
 
 // ==================== QUEUE ====================
 
-template <typename T, std::size_t CAPACITY>
-disruptor_queue<T, CAPACITY>::disruptor_queue() = default;
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                INSTRUMENTATION>::disruptor_queue() = default;
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::create_reader() -> reader&
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::create_reader() -> reader&
 {
   std::lock_guard<std::mutex> lock(_setup_mutex);
   assert(!_operations_started.load(std::memory_order_acquire) &&
@@ -83,38 +164,151 @@ auto disruptor_queue<T, CAPACITY>::create_reader() -> reader&
   return *_readers.emplace_back(std::make_unique<reader>(*this));
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::create_writer() -> writer&
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::create_writer(
+    const backpressure_policy policy) -> writer&
 {
   std::lock_guard<std::mutex> lock(_setup_mutex);
   assert(!_operations_started.load(std::memory_order_acquire) &&
          "Cannot create writer after queue operations have started");
-  return *_writers.emplace_back(std::make_unique<writer>(*this));
+  _has_parking_writers = _has_parking_writers ||
+                         policy == backpressure_policy::spin_then_park;
+  return *_writers.emplace_back(std::make_unique<writer>(*this, policy));
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::start() -> void
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::start() -> void
 {
   std::lock_guard<std::mutex> lock(_setup_mutex);
+
+  for (auto& writer_ptr : _writers)
+  {
+    writer_ptr->update_refresh_distance(INITIAL_SEQUENCE);
+  }
+
   _operations_started.store(true, std::memory_order_release);
 }
 
-template <typename T, std::size_t CAPACITY>
-constexpr auto disruptor_queue<T, CAPACITY>::capacity() noexcept -> size_type
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::set_watermarks(
+    const size_type high, const size_type low,
+    watermark_monitor::callback_type on_crossing, const bool signal_eventfd)
+    -> void
+{
+  std::lock_guard<std::mutex> lock(_setup_mutex);
+  assert(!_operations_started.load(std::memory_order_acquire) &&
+         "Cannot set watermarks after queue operations have started");
+  assert(low < high && high <= CAPACITY && "Invalid watermarks");
+  _watermarks.configure(static_cast<sequence_type>(high),
+                        static_cast<sequence_type>(low),
+                        std::move(on_crossing), signal_eventfd);
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::watermarks() const noexcept
+    -> const watermark_monitor&
+{
+  return _watermarks;
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::statistics() const
+    -> queue_statistics
+{
+  assert(_operations_started.load(std::memory_order_acquire) &&
+         "Cannot take statistics before queue operations have started");
+
+  queue_statistics stats{};
+  stats.sampled_at = std::chrono::steady_clock::now();
+  stats.readers.reserve(_readers.size());
+
+  // Reader sequences first, then the cursors, so that every lag is measured
+  // against a cursor at least as recent as the sequence and is never negative
+  for (const auto& reader_ptr : _readers)
+  {
+    stats.readers.push_back(
+        {reader_ptr->_consumer_sequence.load(std::memory_order_acquire), 0});
+  }
+
+  stats.published_cursor = get_published_cursor();
+  stats.claimed_cursor = _next_sequence.load(std::memory_order_relaxed) - 1;
+
+  for (reader_statistics& reader : stats.readers)
+  {
+    reader.lag = stats.published_cursor - reader.sequence;
+  }
+
+  stats.writers.reserve(_writers.size());
+
+  for (const auto& writer_ptr : _writers)
+  {
+    stats.writers.push_back(
+        {writer_ptr->_wrap_stalls.load(),
+         writer_ptr->dropped_count()});
+  }
+
+  return stats;
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+template <typename Visitor>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::for_each_reader(Visitor&& visitor) const
+    -> void
+{
+  for (const auto& reader_ptr : _readers)
+  {
+    visitor(static_cast<const reader&>(*reader_ptr));
+  }
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+template <typename Visitor>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::for_each_writer(Visitor&& visitor) const
+    -> void
+{
+  for (const auto& writer_ptr : _writers)
+  {
+    visitor(static_cast<const writer&>(*writer_ptr));
+  }
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+constexpr auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                               INSTRUMENTATION>::capacity() noexcept
+    -> size_type
 {
   return CAPACITY;
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::index_from_sequence(
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::index_from_sequence(
     sequence_type sequence) noexcept -> size_type
 {
   return internal::mod_power_of_two<CAPACITY>(sequence);
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::get_min_consumer_sequence() const noexcept
-    -> sequence_type
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::get_min_consumer_sequence()
+    const noexcept -> sequence_type
 {
   if (_readers.empty())
   {
@@ -133,90 +327,364 @@ auto disruptor_queue<T, CAPACITY>::get_min_consumer_sequence() const noexcept
   return min_sequence;
 }
 
+// With several writers, slots are published out of order. Walks forward from
+// a sequence known to be published while each next slot holds that sequence
+// or a later lap of it
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::get_published_cursor()
+    const noexcept -> sequence_type
+{
+  const sequence_type claimed_cursor =
+      _next_sequence.load(std::memory_order_acquire) - 1;
+
+  sequence_type cursor =
+      _readers.empty()
+          ? std::max(INITIAL_SEQUENCE,
+                     claimed_cursor - static_cast<sequence_type>(CAPACITY))
+          : get_min_consumer_sequence();
+
+  while (cursor < claimed_cursor &&
+         _slot_sequences[index_from_sequence(cursor + 1)].value.load(
+             std::memory_order_acquire) >= cursor + 1)
+  {
+    ++cursor;
+  }
+
+  return cursor;
+}
+
 // ==================== WRITER ====================
-template <typename T, std::size_t CAPACITY>
-class alignas(64) disruptor_queue<T, CAPACITY>::writer
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+class alignas(64) disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                                  INSTRUMENTATION>::writer
 {
  public:
-  explicit writer(disruptor_queue& queue) noexcept;
+  writer(disruptor_queue& queue, backpressure_policy policy) noexcept;
 
-  void write(value_type value) noexcept(std::is_nothrow_move_assignable_v<T>);
+  // Returns false if the event was not published because the ring was full
+  // and the writer's policy is fail or drop_newest
+  bool write(value_type value) noexcept(std::is_nothrow_move_assignable_v<T>);
 
   template <typename... Args>
-  void write_emplace(Args&&... args) noexcept(
+  bool write_emplace(Args&&... args) noexcept(
       std::is_nothrow_constructible_v<T, Args...> &&
       std::is_nothrow_move_assignable_v<T>);
 
+  [[nodiscard]] backpressure_policy policy() const noexcept;
+
+  // Number of events discarded under the drop_newest policy. Safe to call
+  // from any thread
+  [[nodiscard]] std::uint64_t dropped_count() const noexcept;
+
+  [[nodiscard]] const WAIT_STRATEGY& wait_strategy() const noexcept;
+
+  [[nodiscard]] const typename INSTRUMENTATION::writer_counters& counters()
+      const noexcept;
+
  private:
-  sequence_type claim_sequence() noexcept;
+  static constexpr std::size_t PARK_SPIN_LIMIT = 1024;
+  static constexpr std::size_t PARK_YIELD_LIMIT = 64;
+
+  bool claim_sequence(sequence_type& claimed_sequence) noexcept;
+  bool try_claim_sequence(sequence_type& claimed_sequence) noexcept;
   void commit_sequence(size_type write_index,
                        sequence_type claimed_sequence) noexcept;
+  bool has_capacity_for(sequence_type claimed_sequence) noexcept;
+  void refresh_min_consumer_sequence(sequence_type claimed_sequence) noexcept;
+  void update_refresh_distance(sequence_type earliest_refresh) noexcept;
+  void rearm_after_low_crossing() noexcept;
   void wait_for_no_wrap(sequence_type claimed_sequence) noexcept;
+  void park_until_no_wrap(sequence_type claimed_sequence) noexcept;
+  void count_wrap_stall() noexcept;
 
   disruptor_queue& _queue;
   sequence_type _cached_min_consumer_sequence{INITIAL_SEQUENCE};
+  // How far ahead of the cached minimum a claim may get before the cache is
+  // refreshed: the capacity, or while below the high watermark just short of
+  // it, so that the claim reaching it triggers a refresh, but no sooner than
+  // high - low claims after the last refresh
+  sequence_type _refresh_distance{static_cast<sequence_type>(CAPACITY)};
+  // Set while the writer has stopped watching for the high watermark
+  bool _awaiting_low_crossing{false};
+  const backpressure_policy _policy;
+  internal::owned_counter _dropped_count;
+  internal::owned_counter _wrap_stalls;
+  [[no_unique_address]] typename INSTRUMENTATION::writer_counters _counters{};
+  [[no_unique_address]] WAIT_STRATEGY _wait_strategy{};
 
   friend class disruptor_queue;
+  friend struct internal::queue_access;
 };
 
-template <typename T, std::size_t CAPACITY>
-disruptor_queue<T, CAPACITY>::writer::writer(disruptor_queue& queue) noexcept
-    : _queue{queue}
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                INSTRUMENTATION>::writer::writer(
+    disruptor_queue& queue, const backpressure_policy policy) noexcept
+    : _queue{queue}, _policy{policy}
 {
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::writer::write(value_type value) noexcept(
-    std::is_nothrow_move_assignable_v<T>) -> void
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::write(
+    value_type value) noexcept(std::is_nothrow_move_assignable_v<T>) -> bool
 {
-  const sequence_type claimed_sequence = claim_sequence();
+  sequence_type claimed_sequence{};
+  if (!claim_sequence(claimed_sequence))
+  {
+    return false;
+  }
 
   const size_type write_index = index_from_sequence(claimed_sequence);
   _queue._buffer[write_index] = std::move(value);
 
   commit_sequence(write_index, claimed_sequence);
+  return true;
 }
 
-template <typename T, std::size_t CAPACITY>
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
 template <typename... Args>
-auto disruptor_queue<T, CAPACITY>::writer::write_emplace(
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::write_emplace(
     Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...> &&
-                             std::is_nothrow_move_assignable_v<T>) -> void
+                             std::is_nothrow_move_assignable_v<T>) -> bool
 {
-  const sequence_type claimed_sequence = claim_sequence();
+  sequence_type claimed_sequence{};
+  if (!claim_sequence(claimed_sequence))
+  {
+    return false;
+  }
 
   const size_type write_index = index_from_sequence(claimed_sequence);
 
   _queue._buffer[write_index] = value_type{std::forward<Args>(args)...};
 
   commit_sequence(write_index, claimed_sequence);
+  return true;
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::writer::claim_sequence() noexcept
-    -> sequence_type
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::policy()
+    const noexcept -> backpressure_policy
 {
-  const sequence_type claimed_sequence =
-      _queue._next_sequence.fetch_add(1, std::memory_order_relaxed);
+  return _policy;
+}
 
-  wait_for_no_wrap(claimed_sequence);
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::dropped_count()
+    const noexcept -> std::uint64_t
+{
+  return _dropped_count.load();
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::wait_strategy()
+    const noexcept -> const WAIT_STRATEGY&
+{
+  return _wait_strategy;
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::counters() const noexcept
+    -> const typename INSTRUMENTATION::writer_counters&
+{
+  return _counters;
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::claim_sequence(
+    sequence_type& claimed_sequence) noexcept -> bool
+{
+  switch (_policy)
+  {
+    case backpressure_policy::block:
+      claimed_sequence =
+          _queue._next_sequence.fetch_add(1, std::memory_order_relaxed);
+      wait_for_no_wrap(claimed_sequence);
+      return true;
+
+    case backpressure_policy::spin_then_park:
+      claimed_sequence =
+          _queue._next_sequence.fetch_add(1, std::memory_order_relaxed);
+      park_until_no_wrap(claimed_sequence);
+      return true;
+
+    case backpressure_policy::fail:
+      return try_claim_sequence(claimed_sequence);
+
+    case backpressure_policy::drop_newest:
+      if (try_claim_sequence(claimed_sequence))
+      {
+        return true;
+      }
+      _dropped_count.add();
+      return false;
+  }
 
-  return claimed_sequence;
+  return false;
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::writer::commit_sequence(
+// A sequence taken with fetch_add must be published, so writers that may give
+// up only claim a sequence once they know its slot is free
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::try_claim_sequence(
+    sequence_type& claimed_sequence) noexcept -> bool
+{
+  sequence_type next_sequence =
+      _queue._next_sequence.load(std::memory_order_relaxed);
+
+  while (true)
+  {
+    if (!has_capacity_for(next_sequence))
+    {
+      return false;
+    }
+
+    if (_queue._next_sequence.compare_exchange_weak(
+            next_sequence, next_sequence + 1, std::memory_order_relaxed,
+            std::memory_order_relaxed))
+    {
+      break;
+    }
+
+    _counters.on_claim_retry();
+  }
+
+  claimed_sequence = next_sequence;
+  return true;
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::commit_sequence(
     const size_type write_index,
     const sequence_type claimed_sequence) noexcept -> void
 {
-  _queue._slot_sequences[write_index].value.store(claimed_sequence,
-                                                  std::memory_order_release);
+  padded_sequence& slot = _queue._slot_sequences[write_index];
+
+  _counters.on_commit(slot.stamp, claimed_sequence);
+  slot.value.store(claimed_sequence, std::memory_order_release);
+  DQ_USDT_PROBE1(publish, claimed_sequence);
+
+  if constexpr (WAIT_STRATEGY::needs_wakeup)
+  {
+    _queue._reader_lot.unpark_all();
+  }
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::has_capacity_for(
+    const sequence_type claimed_sequence) noexcept -> bool
+{
+  rearm_after_low_crossing();
+
+  if (claimed_sequence - _refresh_distance <= _cached_min_consumer_sequence)
+  {
+    return true;
+  }
+
+  refresh_min_consumer_sequence(claimed_sequence);
+
+  const sequence_type wrap_point =
+      claimed_sequence - static_cast<sequence_type>(CAPACITY);
+
+  return wrap_point <= _cached_min_consumer_sequence;
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::refresh_min_consumer_sequence(
+    const sequence_type claimed_sequence) noexcept -> void
+{
+  _cached_min_consumer_sequence = _queue.get_min_consumer_sequence();
+
+  if (_queue._watermarks.enabled())
+  {
+    _queue._watermarks.evaluate(claimed_sequence -
+                                _cached_min_consumer_sequence);
+    update_refresh_distance(claimed_sequence + _queue._watermarks.high() -
+                            _queue._watermarks.low());
+  }
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::writer::wait_for_no_wrap(
+// While above the high watermark there is nothing more for the writer to
+// detect, so it goes back to refreshing only when it might wrap. Below it,
+// a writer whose occupancy sits just short of the high watermark would
+// otherwise rescan every reader on nearly every claim, so refreshes wait for
+// earliest_refresh, at the cost of seeing the crossing up to high - low
+// claims late
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::update_refresh_distance(
+    const sequence_type earliest_refresh) noexcept -> void
+{
+  constexpr auto capacity = static_cast<sequence_type>(CAPACITY);
+
+  const bool watch_high =
+      _queue._watermarks.enabled() && !_queue._watermarks.above_high();
+
+  _awaiting_low_crossing = _queue._watermarks.enabled() && !watch_high;
+  _refresh_distance =
+      watch_high ? std::min(capacity,
+                            std::max(_queue._watermarks.high() - 1,
+                                     earliest_refresh -
+                                         _cached_min_consumer_sequence - 1))
+                 : capacity;
+}
+
+// Readers detect the fall to the low watermark, so the writer checks for it
+// on every claim while it is not watching, rather than a lap later when it
+// next refreshes
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::rearm_after_low_crossing()
+    noexcept -> void
+{
+  if (_awaiting_low_crossing && !_queue._watermarks.above_high())
+  {
+    update_refresh_distance(INITIAL_SEQUENCE);
+  }
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::wait_for_no_wrap(
     sequence_type claimed_sequence) noexcept -> void
 {
+  rearm_after_low_crossing();
+
+  if (claimed_sequence - _refresh_distance <= _cached_min_consumer_sequence)
+  {
+    return;
+  }
+
+  refresh_min_consumer_sequence(claimed_sequence);
+
   const sequence_type wrap_point =
       claimed_sequence - static_cast<sequence_type>(CAPACITY);
 
@@ -225,16 +693,82 @@ auto disruptor_queue<T, CAPACITY>::writer::wait_for_no_wrap(
     return;
   }
 
-  while (wrap_point > _cached_min_consumer_sequence)
+  count_wrap_stall();
+  DQ_USDT_PROBE2(writer_wait_begin, claimed_sequence,
+                 _cached_min_consumer_sequence);
+
+  _wait_strategy.wait_until(
+      [&]() noexcept {
+        _counters.on_wrap_rescan();
+        _cached_min_consumer_sequence = _queue.get_min_consumer_sequence();
+        return wrap_point <= _cached_min_consumer_sequence;
+      },
+      _queue._writer_lot);
+
+  _counters.on_wrap_resume(claimed_sequence);
+  DQ_USDT_PROBE1(writer_wait_end, claimed_sequence);
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::park_until_no_wrap(
+    const sequence_type claimed_sequence) noexcept -> void
+{
+  if (has_capacity_for(claimed_sequence))
+  {
+    return;
+  }
+
+  count_wrap_stall();
+  DQ_USDT_PROBE2(writer_wait_begin, claimed_sequence,
+                 _cached_min_consumer_sequence);
+
+  const auto has_capacity = [&]() noexcept {
+    _counters.on_wrap_rescan();
+    return has_capacity_for(claimed_sequence);
+  };
+
+  std::size_t attempts = 0;
+  while (!has_capacity())
   {
-    _cached_min_consumer_sequence = _queue.get_min_consumer_sequence();
+    if (++attempts < PARK_SPIN_LIMIT)
+    {
+      continue;
+    }
+
+    if (attempts < PARK_SPIN_LIMIT + PARK_YIELD_LIMIT)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    // Readers unpark the writer lot on every read while the queue has
+    // spin_then_park writers
+    _queue._writer_lot.park_until(has_capacity);
+    break;
   }
+
+  _counters.on_wrap_resume(claimed_sequence);
+  DQ_USDT_PROBE1(writer_wait_end, claimed_sequence);
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::writer::count_wrap_stall() noexcept
+    -> void
+{
+  _wrap_stalls.add();
+  _counters.on_wrap_stall();
 }
 
 // ==================== READER ====================
 
-template <typename T, std::size_t CAPACITY>
-class alignas(64) disruptor_queue<T, CAPACITY>::reader
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+class alignas(64) disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                                  INSTRUMENTATION>::reader
 {
  public:
   explicit reader(disruptor_queue& queue) noexcept;
@@ -242,26 +776,44 @@ class alignas(64) disruptor_queue<T, CAPACITY>::reader
   [[nodiscard]] value_type read() noexcept(std::is_nothrow_copy_constructible_v<T>);
   void read(reference output) noexcept(std::is_nothrow_copy_assignable_v<T>);
 
+  [[nodiscard]] const WAIT_STRATEGY& wait_strategy() const noexcept;
+
+  [[nodiscard]] const typename INSTRUMENTATION::reader_counters& counters()
+      const noexcept;
+  // For resetting, e.g. the latency histogram
+  [[nodiscard]] typename INSTRUMENTATION::reader_counters& counters() noexcept;
+
  private:
   sequence_type get_next_read_sequence() noexcept;
   void wait_for_data(std::size_t read_index,
                      sequence_type next_read_sequence) noexcept;
   void update_consumer_sequence(sequence_type next_read_sequence) noexcept;
+  void check_low_watermark() noexcept;
 
   disruptor_queue& _queue;
   std::atomic<sequence_type> _consumer_sequence{INITIAL_SEQUENCE};
+  // The slowest reader at this reader's last occupancy scan, itself if none
+  const reader* _gating_reader{this};
+  [[no_unique_address]] WAIT_STRATEGY _wait_strategy{};
+  [[no_unique_address]] typename INSTRUMENTATION::reader_counters _counters{};
 
   friend class disruptor_queue;
+  friend struct internal::queue_access;
 };
 
-template <typename T, std::size_t CAPACITY>
-disruptor_queue<T, CAPACITY>::reader::reader(disruptor_queue& queue) noexcept
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                INSTRUMENTATION>::reader::reader(
+    disruptor_queue& queue) noexcept
     : _queue(queue)
 {
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::reader::read() noexcept(
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::reader::read() noexcept(
     std::is_nothrow_copy_constructible_v<T>) -> value_type
 {
   const sequence_type next_read_sequence = get_next_read_sequence();
@@ -276,9 +828,11 @@ auto disruptor_queue<T, CAPACITY>::reader::read() noexcept(
   return value;
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::reader::read(reference output) noexcept(
-    std::is_nothrow_copy_assignable_v<T>) -> void
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::reader::read(
+    reference output) noexcept(std::is_nothrow_copy_assignable_v<T>) -> void
 {
   const sequence_type next_read_sequence = get_next_read_sequence();
   const size_type read_index = index_from_sequence(next_read_sequence);
@@ -290,29 +844,137 @@ auto disruptor_queue<T, CAPACITY>::reader::read(reference output) noexcept(
   update_consumer_sequence(next_read_sequence);
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::reader::get_next_read_sequence() noexcept
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::reader::wait_strategy()
+    const noexcept -> const WAIT_STRATEGY&
+{
+  return _wait_strategy;
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::reader::counters() const noexcept
+    -> const typename INSTRUMENTATION::reader_counters&
+{
+  return _counters;
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::reader::counters() noexcept
+    -> typename INSTRUMENTATION::reader_counters&
+{
+  return _counters;
+}
+
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::reader::get_next_read_sequence() noexcept
     -> sequence_type
 {
   return _consumer_sequence.load(std::memory_order_relaxed) + 1;
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::reader::wait_for_data(
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::reader::wait_for_data(
     const std::size_t read_index,
     const sequence_type next_read_sequence) noexcept -> void
 {
-  while (_queue._slot_sequences[read_index].value.load(
-             std::memory_order_acquire) != next_read_sequence)
+  const padded_sequence& slot = _queue._slot_sequences[read_index];
+
+  const auto published = [&]() noexcept {
+    return slot.value.load(std::memory_order_acquire) == next_read_sequence;
+  };
+
+  if (published())
   {
+    _counters.on_read(false);
+    _counters.on_consume(slot.stamp, next_read_sequence);
+    return;
   }
+
+  DQ_USDT_PROBE1(reader_wait_begin, next_read_sequence);
+
+  _wait_strategy.wait_until(
+      [&]() noexcept {
+        if (published())
+        {
+          return true;
+        }
+        _counters.on_wait_spin();
+        return false;
+      },
+      _queue._reader_lot);
+
+  DQ_USDT_PROBE1(reader_wait_end, next_read_sequence);
+
+  _counters.on_read(true);
+  _counters.on_consume(slot.stamp, next_read_sequence);
 }
 
-template <typename T, std::size_t CAPACITY>
-auto disruptor_queue<T, CAPACITY>::reader::update_consumer_sequence(
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::reader::update_consumer_sequence(
     const sequence_type next_read_sequence) noexcept -> void
 {
   _consumer_sequence.store(next_read_sequence, std::memory_order_release);
+  DQ_USDT_PROBE1(consume, next_read_sequence);
+
+  // Writers stop watching occupancy once above the high watermark (and may
+  // stop writing altogether), so readers detect the fall to the low watermark
+  if (_queue._watermarks.enabled() && _queue._watermarks.above_high())
+  {
+    check_low_watermark();
+  }
+
+  if (WAIT_STRATEGY::needs_wakeup || _queue._has_parking_writers)
+  {
+    _queue._writer_lot.unpark_all();
+  }
+}
+
+// Occupancy is at least the claimed cursor minus any one reader's sequence,
+// so while the reader that was slowest at the last scan is still more than
+// the low watermark behind there is no need to scan every reader again
+template <typename T, std::size_t CAPACITY, typename WAIT_STRATEGY,
+          typename INSTRUMENTATION>
+auto disruptor_queue<T, CAPACITY, WAIT_STRATEGY,
+                     INSTRUMENTATION>::reader::check_low_watermark() noexcept
+    -> void
+{
+  const sequence_type claimed_cursor =
+      _queue._next_sequence.load(std::memory_order_relaxed) - 1;
+  const sequence_type gating_sequence =
+      _gating_reader->_consumer_sequence.load(std::memory_order_acquire);
+
+  if (claimed_cursor - gating_sequence > _queue._watermarks.low())
+  {
+    return;
+  }
+
+  sequence_type min_sequence = std::numeric_limits<sequence_type>::max();
+
+  for (const auto& reader_ptr : _queue._readers)
+  {
+    const sequence_type reader_seq =
+        reader_ptr->_consumer_sequence.load(std::memory_order_acquire);
+
+    if (reader_seq < min_sequence)
+    {
+      min_sequence = reader_seq;
+      _gating_reader = reader_ptr.get();
+    }
+  }
+
+  _queue._watermarks.evaluate(claimed_cursor - min_sequence);
 }
 
 }  // namespace dq
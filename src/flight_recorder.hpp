@@ -0,0 +1,367 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bit_utils.hpp"
+#include "instrumentation.hpp"
+#include "tsc_clock.hpp"
+
+namespace dq
+{
+
+struct flight_entry
+{
+  std::int64_t sequence;
+  std::uint64_t ticks;
+  // A reader's wait spins, or a writer's wrap rescans, before the event
+  std::uint64_t wait_spins;
+};
+
+// Ring of the last DEPTH events seen by one reader or writer, indexed by
+// sequence. Recording is three relaxed stores by the owning thread; entries()
+// may run on any thread and skips slots that have not been written yet. An
+// entry overwritten while it is being copied may be torn
+template <std::size_t DEPTH>
+class flight_log
+{
+  static_assert(internal::is_power_of_two(DEPTH),
+                "Flight log depth must be a power of two");
+
+ public:
+  static constexpr std::int64_t UNUSED = -1;
+
+  void record(std::int64_t sequence, std::uint64_t ticks,
+              std::uint64_t wait_spins) noexcept;
+
+  [[nodiscard]] std::vector<flight_entry> entries() const;
+
+ private:
+  struct slot
+  {
+    std::atomic<std::int64_t> sequence{UNUSED};
+    std::atomic<std::uint64_t> ticks{0};
+    std::atomic<std::uint64_t> wait_spins{0};
+  };
+
+  std::array<slot, DEPTH> _slots{};
+};
+
+template <std::size_t DEPTH>
+auto flight_log<DEPTH>::record(const std::int64_t sequence,
+                               const std::uint64_t ticks,
+                               const std::uint64_t wait_spins) noexcept -> void
+{
+  slot& entry = _slots[static_cast<std::size_t>(sequence) & (DEPTH - 1)];
+  entry.ticks.store(ticks, std::memory_order_relaxed);
+  entry.wait_spins.store(wait_spins, std::memory_order_relaxed);
+  entry.sequence.store(sequence, std::memory_order_relaxed);
+}
+
+template <std::size_t DEPTH>
+auto flight_log<DEPTH>::entries() const -> std::vector<flight_entry>
+{
+  std::vector<flight_entry> result;
+  result.reserve(DEPTH);
+
+  for (const slot& entry : _slots)
+  {
+    const std::int64_t sequence =
+        entry.sequence.load(std::memory_order_relaxed);
+
+    if (sequence != UNUSED)
+    {
+      result.push_back({sequence, entry.ticks.load(std::memory_order_relaxed),
+                        entry.wait_spins.load(std::memory_order_relaxed)});
+    }
+  }
+
+  return result;
+}
+
+// Always-on record of the last DEPTH events on top of BASE: writers log when
+// they published each sequence and how many times they rescanned the readers
+// waiting for its slot, readers when they consumed it and how many times they
+// found it unpublished first. Timestamps are tsc_clock ticks
+template <typename BASE = no_instrumentation, std::size_t DEPTH = 1024>
+struct flight_recorder_instrumentation : BASE
+{
+  static constexpr std::size_t FLIGHT_DEPTH = DEPTH;
+
+  struct alignas(64) writer_counters : BASE::writer_counters
+  {
+    void on_wrap_rescan() noexcept
+    {
+      BASE::writer_counters::on_wrap_rescan();
+      ++_wrap_rescans;
+    }
+
+    template <typename STAMP>
+    void on_commit(STAMP& stamp, std::int64_t sequence) noexcept
+    {
+      BASE::writer_counters::on_commit(stamp, sequence);
+      flight.record(sequence, tsc_clock::now(), _wrap_rescans);
+      _wrap_rescans = 0;
+    }
+
+    flight_log<DEPTH> flight;
+
+   private:
+    std::uint64_t _wrap_rescans{0};
+  };
+
+  struct alignas(64) reader_counters : BASE::reader_counters
+  {
+    void on_wait_spin() noexcept
+    {
+      BASE::reader_counters::on_wait_spin();
+      ++_wait_spins;
+    }
+
+    template <typename STAMP>
+    void on_consume(const STAMP& stamp, std::int64_t sequence) noexcept
+    {
+      BASE::reader_counters::on_consume(stamp, sequence);
+      flight.record(sequence, tsc_clock::now(), _wait_spins);
+      _wait_spins = 0;
+    }
+
+    flight_log<DEPTH> flight;
+
+   private:
+    std::uint64_t _wait_spins{0};
+  };
+};
+
+struct flight_record
+{
+  static constexpr std::uint64_t MISSING =
+      std::numeric_limits<std::uint64_t>::max();
+
+  std::int64_t sequence;
+  // MISSING where the event has aged out of, or never reached, that log
+  std::uint64_t publish_ticks;
+  // Times the writer rescanned the readers waiting for the slot
+  std::uint64_t publish_wrap_rescans;
+  std::vector<std::uint64_t> consume_ticks;
+  std::vector<std::uint64_t> wait_spins;
+};
+
+// Joins the writers' and readers' flight logs by sequence, oldest first. Only
+// sequences still held by some writer's log are reported
+template <typename QUEUE>
+[[nodiscard]] std::vector<flight_record> collect_flight_records(
+    const QUEUE& queue)
+{
+  std::map<std::int64_t, flight_record> records;
+
+  queue.for_each_writer([&](const auto& writer) {
+    for (const flight_entry& entry : writer.counters().flight.entries())
+    {
+      records[entry.sequence] = {entry.sequence, entry.ticks,
+                                 entry.wait_spins, {}, {}};
+    }
+  });
+
+  std::size_t reader_count = 0;
+  queue.for_each_reader([&](const auto& /*reader*/) { ++reader_count; });
+
+  for (auto& [sequence, record] : records)
+  {
+    record.consume_ticks.assign(reader_count, flight_record::MISSING);
+    record.wait_spins.assign(reader_count, 0);
+  }
+
+  std::size_t reader_index = 0;
+  queue.for_each_reader([&](const auto& reader) {
+    for (const flight_entry& entry : reader.counters().flight.entries())
+    {
+      const auto record = records.find(entry.sequence);
+
+      if (record != records.end())
+      {
+        record->second.consume_ticks[reader_index] = entry.ticks;
+        record->second.wait_spins[reader_index] = entry.wait_spins;
+      }
+    }
+    ++reader_index;
+  });
+
+  std::vector<flight_record> result;
+  result.reserve(records.size());
+
+  for (auto& [sequence, record] : records)
+  {
+    result.push_back(std::move(record));
+  }
+
+  return result;
+}
+
+// One CSV row per record with times in nanoseconds since the oldest publish.
+// Missing consume times are left empty
+inline void write_flight_records(std::ostream& out,
+                                 const std::vector<flight_record>& records)
+{
+  const std::size_t reader_count =
+      records.empty() ? 0 : records.front().consume_ticks.size();
+
+  out << "sequence,publish_ns,publish_wrap_rescans";
+  for (std::size_t i = 0; i < reader_count; ++i)
+  {
+    out << ",reader" << i << "_consume_ns,reader" << i << "_wait_spins";
+  }
+  out << '\n';
+
+  std::uint64_t origin = std::numeric_limits<std::uint64_t>::max();
+  for (const flight_record& record : records)
+  {
+    origin = std::min(origin, record.publish_ticks);
+  }
+
+  const auto ns_since_origin = [&](const std::uint64_t ticks) {
+    return tsc_clock::to_nanoseconds(ticks > origin ? ticks - origin : 0);
+  };
+
+  for (const flight_record& record : records)
+  {
+    out << record.sequence << ',' << ns_since_origin(record.publish_ticks)
+        << ',' << record.publish_wrap_rescans;
+
+    for (std::size_t i = 0; i < reader_count; ++i)
+    {
+      out << ',';
+      if (record.consume_ticks[i] != flight_record::MISSING)
+      {
+        out << ns_since_origin(record.consume_ticks[i]);
+      }
+      out << ',' << record.wait_spins[i];
+    }
+    out << '\n';
+  }
+}
+
+// Writes the queue's flight records to path as CSV. Safe to call while the
+// queue is running. Returns false if the file could not be written
+template <typename QUEUE>
+bool dump_flight_recorder(const QUEUE& queue, const std::string& path)
+{
+  std::ofstream out(path, std::ios::trunc);
+
+  if (!out)
+  {
+    return false;
+  }
+
+  write_flight_records(out, collect_flight_records(queue));
+  return static_cast<bool>(out.flush());
+}
+
+// Runs a dump callback on a background thread whenever the process receives
+// the given signal, e.g. SIGUSR1. The signal handler only sets a lock-free
+// flag, which the thread polls. One trigger may be installed at a time; the
+// previous handler is restored on destruction
+class flight_recorder_signal_trigger
+{
+ public:
+  flight_recorder_signal_trigger(
+      int signal_number, std::function<void()> dump,
+      std::chrono::milliseconds poll_interval = std::chrono::milliseconds(100));
+  ~flight_recorder_signal_trigger();
+
+  flight_recorder_signal_trigger(const flight_recorder_signal_trigger&) =
+      delete;
+  flight_recorder_signal_trigger& operator=(
+      const flight_recorder_signal_trigger&) = delete;
+
+ private:
+  static std::atomic<bool>& pending() noexcept;
+  static std::atomic<bool>& installed() noexcept;
+  static void handle_signal(int signal_number) noexcept;
+
+  const int _signal_number;
+  struct sigaction _previous_action
+  {
+  };
+  std::atomic<bool> _stop{false};
+  std::thread _poller;
+};
+
+inline flight_recorder_signal_trigger::flight_recorder_signal_trigger(
+    const int signal_number, std::function<void()> dump,
+    const std::chrono::milliseconds poll_interval)
+    : _signal_number{signal_number}
+{
+  static_assert(std::atomic<bool>::is_always_lock_free,
+                "The signal handler needs a lock-free flag");
+
+  [[maybe_unused]] const bool was_installed = installed().exchange(true);
+  assert(!was_installed && "Only one flight recorder trigger may be installed");
+
+  pending().store(false, std::memory_order_relaxed);
+
+  struct sigaction action
+  {
+  };
+  action.sa_handler = &flight_recorder_signal_trigger::handle_signal;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(_signal_number, &action, &_previous_action);
+
+  _poller = std::thread([this, dump = std::move(dump), poll_interval]() {
+    while (!_stop.load(std::memory_order_acquire))
+    {
+      if (pending().exchange(false, std::memory_order_acq_rel))
+      {
+        dump();
+      }
+      std::this_thread::sleep_for(poll_interval);
+    }
+  });
+}
+
+inline flight_recorder_signal_trigger::~flight_recorder_signal_trigger()
+{
+  sigaction(_signal_number, &_previous_action, nullptr);
+
+  _stop.store(true, std::memory_order_release);
+  _poller.join();
+
+  installed().store(false);
+}
+
+inline auto flight_recorder_signal_trigger::pending() noexcept
+    -> std::atomic<bool>&
+{
+  static std::atomic<bool> flag{false};
+  return flag;
+}
+
+inline auto flight_recorder_signal_trigger::installed() noexcept
+    -> std::atomic<bool>&
+{
+  static std::atomic<bool> flag{false};
+  return flag;
+}
+
+inline auto flight_recorder_signal_trigger::handle_signal(
+    const int /*signal_number*/) noexcept -> void
+{
+  pending().store(true, std::memory_order_relaxed);
+}
+
+}  // namespace dq
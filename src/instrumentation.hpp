@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdint>
+
+#include "latency_histogram.hpp"
+#include "owned_counter.hpp"
+#include "tsc_clock.hpp"
+
+namespace dq
+{
+
+// Instrumentation policies supply a writer_counters and a reader_counters type
+// whose hooks the queue calls on the hot path, and a slot_stamp type stored in
+// the padding of each slot's sequence. Each reader and writer owns one
+// counters instance, so every hook runs on a single thread. Policies derive
+// from no_instrumentation, or from another policy, and hide the hooks they
+// implement.
+//
+// The default policy's counters are empty and its hooks are empty inline
+// functions, so an uninstrumented queue compiles to the same code as before
+struct no_instrumentation
+{
+  struct slot_stamp
+  {
+  };
+
+  struct writer_counters
+  {
+    void on_claim_retry() noexcept {}
+    void on_wrap_stall() noexcept {}
+    void on_wrap_rescan() noexcept {}
+    // The stalled claim may now be written
+    void on_wrap_resume(std::int64_t /*sequence*/) noexcept {}
+
+    // Called before the slot is published
+    template <typename STAMP>
+    void on_commit(STAMP& /*stamp*/, std::int64_t /*sequence*/) noexcept
+    {
+    }
+  };
+
+  struct reader_counters
+  {
+    void on_wait_spin() noexcept {}
+    void on_read(bool /*waited*/) noexcept {}
+
+    // Called once the slot is visible and before the reader releases it
+    template <typename STAMP>
+    void on_consume(const STAMP& /*stamp*/, std::int64_t /*sequence*/) noexcept
+    {
+    }
+  };
+};
+
+// Counts hot-path events in relaxed counters padded onto the owner's own
+// cache line. A reader's batch is the run of events it consumed without
+// waiting; it is recorded once the reader next has to wait
+struct counting_instrumentation : no_instrumentation
+{
+  struct alignas(64) writer_counters : no_instrumentation::writer_counters
+  {
+    void on_claim_retry() noexcept { claim_retries.add(); }
+    void on_wrap_stall() noexcept { wrap_stalls.add(); }
+    void on_wrap_rescan() noexcept { wrap_rescans.add(); }
+
+    // Failed compare-exchanges by writers that may give up on a full ring
+    internal::owned_counter claim_retries;
+    // Claims that had to wait for readers
+    internal::owned_counter wrap_stalls;
+    // Re-reads of every reader's sequence while waiting
+    internal::owned_counter wrap_rescans;
+  };
+
+  struct alignas(64) reader_counters : no_instrumentation::reader_counters
+  {
+    void on_wait_spin() noexcept { wait_spins.add(); }
+
+    void on_read(bool waited) noexcept
+    {
+      if (waited)
+      {
+        waits.add();
+
+        if (_current_batch != 0)
+        {
+          batches.add();
+          batched_events.add(_current_batch);
+          max_batch.raise_to(_current_batch);
+          _current_batch = 0;
+        }
+      }
+
+      ++_current_batch;
+    }
+
+    // Failed checks for data in wait_for_data
+    internal::owned_counter wait_spins;
+    // Reads that found no data and had to wait
+    internal::owned_counter waits;
+    internal::owned_counter batches;
+    internal::owned_counter batched_events;
+    internal::owned_counter max_batch;
+
+   private:
+    std::uint64_t _current_batch{0};
+  };
+};
+
+// Adds producer-to-consumer latency on top of BASE: writers stamp each slot
+// with tsc_clock ticks as they publish it and each reader records the elapsed
+// ticks into its own histogram. Convert with tsc_clock::to_nanoseconds
+template <typename BASE = no_instrumentation>
+struct latency_instrumentation : BASE
+{
+  struct slot_stamp : BASE::slot_stamp
+  {
+    std::uint64_t publish_ticks;
+  };
+
+  struct writer_counters : BASE::writer_counters
+  {
+    template <typename STAMP>
+    void on_commit(STAMP& stamp, std::int64_t sequence) noexcept
+    {
+      BASE::writer_counters::on_commit(stamp, sequence);
+      stamp.publish_ticks = tsc_clock::now();
+    }
+  };
+
+  struct alignas(64) reader_counters : BASE::reader_counters
+  {
+    template <typename STAMP>
+    void on_consume(const STAMP& stamp, std::int64_t sequence) noexcept
+    {
+      BASE::reader_counters::on_consume(stamp, sequence);
+
+      // Counters of different cores may be slightly out of step
+      const std::uint64_t now = tsc_clock::now();
+      latency.record(now > stamp.publish_ticks ? now - stamp.publish_ticks
+                                               : 0);
+    }
+
+    // In tsc_clock ticks
+    latency_histogram latency;
+  };
+};
+
+}  // namespace dq
+
+// Lets a build instrument every queue that does not choose a policy itself,
+// e.g. --copt=-DDQ_DEFAULT_INSTRUMENTATION=dq::counting_instrumentation
+#ifndef DQ_DEFAULT_INSTRUMENTATION
+#define DQ_DEFAULT_INSTRUMENTATION ::dq::no_instrumentation
+#endif
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "owned_counter.hpp"
+
+namespace dq
+{
+
+// Log-linear bucketing in the style of HdrHistogram: values below
+// SUB_BUCKET_COUNT get a bucket each, every power of two above that is split
+// into SUB_BUCKET_COUNT equal buckets, bounding the relative error to ~3%
+class histogram_buckets
+{
+ public:
+  static constexpr unsigned SUB_BUCKET_BITS = 5;
+  static constexpr std::size_t SUB_BUCKET_COUNT = std::size_t{1}
+                                                  << SUB_BUCKET_BITS;
+  static constexpr std::size_t BUCKET_COUNT =
+      (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+  [[nodiscard]] static constexpr std::size_t index_of(
+      std::uint64_t value) noexcept;
+  [[nodiscard]] static constexpr std::uint64_t lowest_value(
+      std::size_t index) noexcept;
+  [[nodiscard]] static constexpr std::uint64_t highest_value(
+      std::size_t index) noexcept;
+};
+
+constexpr auto histogram_buckets::index_of(const std::uint64_t value) noexcept
+    -> std::size_t
+{
+  if (value < SUB_BUCKET_COUNT)
+  {
+    return static_cast<std::size_t>(value);
+  }
+
+  const unsigned shift =
+      static_cast<unsigned>(std::bit_width(value)) - 1 - SUB_BUCKET_BITS;
+
+  return (shift + 1) * SUB_BUCKET_COUNT +
+         static_cast<std::size_t>((value >> shift) - SUB_BUCKET_COUNT);
+}
+
+constexpr auto histogram_buckets::lowest_value(const std::size_t index) noexcept
+    -> std::uint64_t
+{
+  if (index < SUB_BUCKET_COUNT)
+  {
+    return index;
+  }
+
+  const std::size_t shift = index / SUB_BUCKET_COUNT - 1;
+  const std::uint64_t sub_bucket = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+
+  return sub_bucket << shift;
+}
+
+constexpr auto histogram_buckets::highest_value(
+    const std::size_t index) noexcept -> std::uint64_t
+{
+  if (index + 1 == BUCKET_COUNT)
+  {
+    return ~std::uint64_t{0};
+  }
+
+  return lowest_value(index + 1) - 1;
+}
+
+// Point-in-time copy of a histogram's bucket counts
+class histogram_snapshot
+{
+ public:
+  histogram_snapshot() = default;
+  explicit histogram_snapshot(std::vector<std::uint64_t> counts);
+
+  [[nodiscard]] std::uint64_t total_count() const noexcept;
+  [[nodiscard]] std::uint64_t min() const noexcept;
+  [[nodiscard]] std::uint64_t max() const noexcept;
+  [[nodiscard]] double mean() const noexcept;
+
+  // Highest value equivalent to the recorded value at the given percentile
+  // in [0, 100]. Zero when empty
+  [[nodiscard]] std::uint64_t value_at_percentile(
+      double percentile) const noexcept;
+
+  [[nodiscard]] const std::vector<std::uint64_t>& counts() const noexcept;
+
+  void merge(const histogram_snapshot& other);
+
+ private:
+  std::vector<std::uint64_t> _counts =
+      std::vector<std::uint64_t>(histogram_buckets::BUCKET_COUNT, 0);
+  std::uint64_t _total{0};
+};
+
+inline histogram_snapshot::histogram_snapshot(std::vector<std::uint64_t> counts)
+    : _counts{std::move(counts)}
+{
+  _counts.resize(histogram_buckets::BUCKET_COUNT, 0);
+
+  for (const std::uint64_t count : _counts)
+  {
+    _total += count;
+  }
+}
+
+inline auto histogram_snapshot::total_count() const noexcept -> std::uint64_t
+{
+  return _total;
+}
+
+inline auto histogram_snapshot::min() const noexcept -> std::uint64_t
+{
+  for (std::size_t i = 0; i < _counts.size(); ++i)
+  {
+    if (_counts[i] != 0)
+    {
+      return histogram_buckets::lowest_value(i);
+    }
+  }
+
+  return 0;
+}
+
+inline auto histogram_snapshot::max() const noexcept -> std::uint64_t
+{
+  for (std::size_t i = _counts.size(); i > 0; --i)
+  {
+    if (_counts[i - 1] != 0)
+    {
+      return histogram_buckets::highest_value(i - 1);
+    }
+  }
+
+  return 0;
+}
+
+inline auto histogram_snapshot::mean() const noexcept -> double
+{
+  if (_total == 0)
+  {
+    return 0.0;
+  }
+
+  double sum = 0.0;
+
+  for (std::size_t i = 0; i < _counts.size(); ++i)
+  {
+    if (_counts[i] != 0)
+    {
+      const double midpoint =
+          (static_cast<double>(histogram_buckets::lowest_value(i)) +
+           static_cast<double>(histogram_buckets::highest_value(i))) /
+          2.0;
+      sum += midpoint * static_cast<double>(_counts[i]);
+    }
+  }
+
+  return sum / static_cast<double>(_total);
+}
+
+inline auto histogram_snapshot::value_at_percentile(
+    const double percentile) const noexcept -> std::uint64_t
+{
+  if (_total == 0)
+  {
+    return 0;
+  }
+
+  const double clamped = std::clamp(percentile, 0.0, 100.0);
+  const auto target = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(
+             clamped / 100.0 * static_cast<double>(_total) + 0.5));
+
+  std::uint64_t seen = 0;
+
+  for (std::size_t i = 0; i < _counts.size(); ++i)
+  {
+    seen += _counts[i];
+
+    if (seen >= target)
+    {
+      return histogram_buckets::highest_value(i);
+    }
+  }
+
+  return max();
+}
+
+inline auto histogram_snapshot::counts() const noexcept
+    -> const std::vector<std::uint64_t>&
+{
+  return _counts;
+}
+
+inline auto histogram_snapshot::merge(const histogram_snapshot& other) -> void
+{
+  for (std::size_t i = 0; i < _counts.size(); ++i)
+  {
+    _counts[i] += other._counts[i];
+  }
+
+  _total += other._total;
+}
+
+// Histogram recorded by a single owning thread with relaxed stores, and
+// snapshotted or reset from any thread. Reset does not touch the owner's
+// counters, it records a baseline that later snapshots subtract. Both load
+// the counts under the baseline lock, so a snapshot never pairs counts older
+// than the baseline it subtracts
+class latency_histogram
+{
+ public:
+  void record(std::uint64_t value) noexcept;
+
+  [[nodiscard]] histogram_snapshot snapshot() const;
+  void reset();
+
+ private:
+  std::vector<std::uint64_t> load_counts() const;
+
+  std::array<internal::owned_counter, histogram_buckets::BUCKET_COUNT>
+      _counts{};
+
+  mutable std::mutex _baseline_mutex;
+  std::vector<std::uint64_t> _baseline =
+      std::vector<std::uint64_t>(histogram_buckets::BUCKET_COUNT, 0);
+};
+
+inline auto latency_histogram::record(const std::uint64_t value) noexcept
+    -> void
+{
+  _counts[histogram_buckets::index_of(value)].add();
+}
+
+inline auto latency_histogram::snapshot() const -> histogram_snapshot
+{
+  std::lock_guard<std::mutex> lock(_baseline_mutex);
+
+  std::vector<std::uint64_t> counts = load_counts();
+
+  for (std::size_t i = 0; i < counts.size(); ++i)
+  {
+    counts[i] -= std::min(counts[i], _baseline[i]);
+  }
+
+  return histogram_snapshot{std::move(counts)};
+}
+
+inline auto latency_histogram::reset() -> void
+{
+  std::lock_guard<std::mutex> lock(_baseline_mutex);
+  _baseline = load_counts();
+}
+
+inline auto latency_histogram::load_counts() const -> std::vector<std::uint64_t>
+{
+  std::vector<std::uint64_t> counts(histogram_buckets::BUCKET_COUNT);
+
+  for (std::size_t i = 0; i < counts.size(); ++i)
+  {
+    counts[i] = _counts[i].load();
+  }
+
+  return counts;
+}
+
+}  // namespace dq
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace dq::internal
+{
+
+// Counter incremented only by the thread that owns it, so it needs no locked
+// instruction, but that any thread may read
+class owned_counter
+{
+ public:
+  void add(std::uint64_t amount = 1) noexcept
+  {
+    _value.store(_value.load(std::memory_order_relaxed) + amount,
+                 std::memory_order_relaxed);
+  }
+
+  void raise_to(std::uint64_t value) noexcept
+  {
+    if (value > _value.load(std::memory_order_relaxed))
+    {
+      _value.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] std::uint64_t load() const noexcept
+  {
+    return _value.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<std::uint64_t> _value{0};
+};
+
+}  // namespace dq::internal
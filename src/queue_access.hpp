@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+#include "disruptor_queue.hpp"
+
+namespace dq::internal
+{
+
+// Runs one step of a write or read on its own, for tests and microbenchmarks
+// of the queue's primitives. A write is claim_sequence then commit_sequence,
+// a read next_read_sequence, wait_for_data and update_consumer_sequence.
+// Skipping or reordering steps breaks the queue's invariants, so nothing else
+// may use this
+struct queue_access
+{
+  // A slot's sequence and its instrumentation stamp, for layout checks
+  template <typename QUEUE>
+  using slot_type = typename QUEUE::padded_sequence;
+
+  // Blocks (or fails) as the writer's backpressure policy dictates
+  template <typename WRITER>
+  static bool claim_sequence(WRITER& writer,
+                             std::int64_t& claimed_sequence) noexcept
+  {
+    return writer.claim_sequence(claimed_sequence);
+  }
+
+  // Publishes the sequence without writing its slot
+  template <typename WRITER>
+  static void commit_sequence(WRITER& writer,
+                              const std::int64_t claimed_sequence) noexcept
+  {
+    writer.commit_sequence(writer._queue.index_from_sequence(claimed_sequence),
+                           claimed_sequence);
+  }
+
+  template <typename QUEUE>
+  [[nodiscard]] static std::int64_t min_consumer_sequence(
+      const QUEUE& queue) noexcept
+  {
+    return queue.get_min_consumer_sequence();
+  }
+
+  template <typename READER>
+  [[nodiscard]] static std::int64_t next_read_sequence(READER& reader) noexcept
+  {
+    return reader.get_next_read_sequence();
+  }
+
+  // Waits with the reader's strategy until the sequence is published
+  template <typename READER>
+  static void wait_for_data(READER& reader,
+                            const std::int64_t next_read_sequence) noexcept
+  {
+    reader.wait_for_data(reader._queue.index_from_sequence(next_read_sequence),
+                         next_read_sequence);
+  }
+
+  template <typename READER>
+  static void update_consumer_sequence(
+      READER& reader, const std::int64_t next_read_sequence) noexcept
+  {
+    reader.update_consumer_sequence(next_read_sequence);
+  }
+};
+
+}  // namespace dq::internal
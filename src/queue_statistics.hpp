@@ -0,0 +1,115 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dq
+{
+
+struct reader_statistics
+{
+  std::int64_t sequence;
+  // Published cursor minus the reader's sequence
+  std::int64_t lag;
+};
+
+struct writer_statistics
+{
+  // Claims that found the ring full and had to wait for readers
+  std::uint64_t wrap_stalls;
+  std::uint64_t dropped;
+};
+
+struct queue_statistics
+{
+  std::chrono::steady_clock::time_point sampled_at;
+  std::int64_t claimed_cursor;
+  // Highest sequence up to which every event has been published
+  std::int64_t published_cursor;
+  std::vector<reader_statistics> readers;
+  std::vector<writer_statistics> writers;
+};
+
+namespace internal
+{
+
+// Events-per-second EWMA over irregularly spaced samples of a sequence
+class rate_estimator
+{
+ public:
+  using clock = std::chrono::steady_clock;
+
+  static constexpr std::chrono::duration<double> RATE_TIME_CONSTANT{1.0};
+
+  double update(std::int64_t sequence, clock::time_point now) noexcept;
+
+ private:
+  bool _sampled{false};
+  bool _has_rate{false};
+  std::int64_t _last_sequence{0};
+  clock::time_point _last_time{};
+  double _rate{0.0};
+};
+
+inline auto rate_estimator::update(const std::int64_t sequence,
+                                   const clock::time_point now) noexcept
+    -> double
+{
+  if (_sampled)
+  {
+    const std::chrono::duration<double> elapsed = now - _last_time;
+
+    if (elapsed.count() > 0.0)
+    {
+      const double instant_rate =
+          static_cast<double>(sequence - _last_sequence) / elapsed.count();
+      const double alpha =
+          _has_rate ? 1.0 - std::exp(-elapsed / RATE_TIME_CONSTANT) : 1.0;
+      _rate += alpha * (instant_rate - _rate);
+      _has_rate = true;
+    }
+  }
+
+  _sampled = true;
+  _last_sequence = sequence;
+  _last_time = now;
+
+  return _rate;
+}
+
+}  // namespace internal
+
+// Events per second of each reader across the snapshots one observer takes.
+// Every observer keeps its own, so observers polling a queue at different
+// intervals do not disturb each other's rates
+class reader_rates
+{
+ public:
+  // One rate per reader in the snapshot, exponentially weighted over
+  // rate_estimator::RATE_TIME_CONSTANT, zero on the first snapshot
+  const std::vector<double>& update(const queue_statistics& stats);
+
+ private:
+  std::vector<internal::rate_estimator> _estimators{};
+  std::vector<double> _rates{};
+};
+
+inline auto reader_rates::update(const queue_statistics& stats)
+    -> const std::vector<double>&
+{
+  _estimators.resize(stats.readers.size());
+  _rates.resize(stats.readers.size());
+
+  for (std::size_t i = 0; i < stats.readers.size(); ++i)
+  {
+    _rates[i] =
+        _estimators[i].update(stats.readers[i].sequence, stats.sampled_at);
+  }
+
+  return _rates;
+}
+
+}  // namespace dq
@@ -0,0 +1,605 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "latency_histogram.hpp"
+#include "queue_statistics.hpp"
+#include "tsc_clock.hpp"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dq
+{
+
+// Layout of a queue's shared-memory statistics region, version
+// SHM_STATS_VERSION: the header, then one shm_reader_stats per reader, one
+// shm_writer_stats per writer, and finally histogram_buckets::BUCKET_COUNT
+// latency bucket counts per reader. Every field is written with relaxed
+// stores by the publishing process and may be read at any time, so an
+// inspector may see a snapshot that is mid-update
+inline constexpr std::uint32_t SHM_STATS_MAGIC = 0x54535144;  // "DQST"
+inline constexpr std::uint32_t SHM_STATS_VERSION = 1;
+
+struct alignas(64) shm_stats_header
+{
+  // Stored with release once every other field is written; inspectors load
+  // it with acquire before trusting the rest
+  std::atomic<std::uint32_t> magic;
+  // Written once before the magic
+  std::uint32_t version;
+  std::uint32_t reader_count;
+  std::uint32_t writer_count;
+  std::uint32_t histogram_bucket_count;
+  std::uint32_t reserved;
+  std::uint64_t capacity;
+  std::uint64_t region_size;
+
+  // Bumped after every refresh
+  std::atomic<std::uint64_t> updates;
+  std::atomic<std::int64_t> publisher_pid;
+  // steady_clock of the publisher, so only differences are meaningful
+  std::atomic<std::int64_t> updated_ns;
+  std::atomic<std::int64_t> claimed_cursor;
+  std::atomic<std::int64_t> published_cursor;
+  std::atomic<double> nanoseconds_per_tick;
+};
+
+struct alignas(64) shm_reader_stats
+{
+  std::atomic<std::int64_t> sequence;
+  std::atomic<std::int64_t> lag;
+  // Zero unless the queue uses counting_instrumentation
+  std::atomic<std::uint64_t> wait_spins;
+  std::atomic<std::uint64_t> waits;
+  std::atomic<std::uint64_t> batches;
+  std::atomic<std::uint64_t> batched_events;
+};
+
+struct alignas(64) shm_writer_stats
+{
+  std::atomic<std::uint64_t> wrap_stalls;
+  std::atomic<std::uint64_t> dropped;
+  // Zero unless the queue uses counting_instrumentation
+  std::atomic<std::uint64_t> claim_retries;
+  std::atomic<std::uint64_t> wrap_rescans;
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free &&
+                  std::atomic<std::uint64_t>::is_always_lock_free &&
+                  std::atomic<std::int64_t>::is_always_lock_free &&
+                  std::atomic<double>::is_always_lock_free,
+              "Shared-memory statistics need address-free atomics");
+
+// Offsets of each part of a region with the given shape
+struct shm_stats_layout
+{
+  std::size_t reader_count;
+  std::size_t writer_count;
+
+  [[nodiscard]] std::size_t readers_offset() const noexcept
+  {
+    return sizeof(shm_stats_header);
+  }
+
+  [[nodiscard]] std::size_t writers_offset() const noexcept
+  {
+    return readers_offset() + reader_count * sizeof(shm_reader_stats);
+  }
+
+  [[nodiscard]] std::size_t histograms_offset() const noexcept
+  {
+    return writers_offset() + writer_count * sizeof(shm_writer_stats);
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    return histograms_offset() + reader_count *
+                                     histogram_buckets::BUCKET_COUNT *
+                                     sizeof(std::atomic<std::uint64_t>);
+  }
+};
+
+// A mapping of a named POSIX shared-memory statistics region. The publishing
+// side creates (and on destruction unlinks) it, inspectors open it read-only.
+// Check valid() after construction; regions of another version are rejected.
+// create() fails if a region of that name belongs to a live publisher, and
+// only replaces one whose publisher has exited
+class shm_stats_region
+{
+ public:
+  static shm_stats_region create(const std::string& name,
+                                 std::size_t reader_count,
+                                 std::size_t writer_count,
+                                 std::uint64_t capacity);
+  static shm_stats_region open(const std::string& name);
+
+  shm_stats_region() = default;
+  ~shm_stats_region();
+
+  shm_stats_region(shm_stats_region&& other) noexcept;
+  shm_stats_region& operator=(shm_stats_region&& other) noexcept;
+  shm_stats_region(const shm_stats_region&) = delete;
+  shm_stats_region& operator=(const shm_stats_region&) = delete;
+
+  [[nodiscard]] bool valid() const noexcept;
+
+  [[nodiscard]] shm_stats_header& header() const noexcept;
+  [[nodiscard]] shm_reader_stats& reader(std::size_t index) const noexcept;
+  [[nodiscard]] shm_writer_stats& writer(std::size_t index) const noexcept;
+  [[nodiscard]] std::atomic<std::uint64_t>* histogram(
+      std::size_t reader_index) const noexcept;
+
+  // Copies a reader's histogram out of the region
+  [[nodiscard]] histogram_snapshot histogram_snapshot_of(
+      std::size_t reader_index) const;
+
+ private:
+  [[nodiscard]] shm_stats_layout layout() const noexcept;
+  [[nodiscard]] std::byte* at(std::size_t offset) const noexcept;
+
+  static bool has_live_publisher(const std::string& name) noexcept;
+
+  std::string _name{};
+  void* _address{nullptr};
+  std::size_t _size{0};
+  bool _owner{false};
+};
+
+inline auto shm_stats_region::create(const std::string& name,
+                                     const std::size_t reader_count,
+                                     const std::size_t writer_count,
+                                     const std::uint64_t capacity)
+    -> shm_stats_region
+{
+  shm_stats_region region;
+
+#ifdef __linux__
+  const shm_stats_layout shape{reader_count, writer_count};
+
+  constexpr int flags = O_CREAT | O_EXCL | O_RDWR;
+
+  int fd = ::shm_open(name.c_str(), flags, 0644);
+  if (fd < 0 && errno == EEXIST && !has_live_publisher(name))
+  {
+    // The region's publisher has exited. Two creators reclaiming the same
+    // abandoned name at once can still race here
+    ::shm_unlink(name.c_str());
+    fd = ::shm_open(name.c_str(), flags, 0644);
+  }
+  if (fd < 0)
+  {
+    return region;
+  }
+
+  void* const address =
+      ::ftruncate(fd, static_cast<off_t>(shape.size())) == 0
+          ? ::mmap(nullptr, shape.size(), PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0)
+          : MAP_FAILED;
+  ::close(fd);
+
+  // O_EXCL made the name ours, so removing it cannot affect another publisher
+  if (address == MAP_FAILED)
+  {
+    ::shm_unlink(name.c_str());
+    return region;
+  }
+
+  region._name = name;
+  region._address = address;
+  region._size = shape.size();
+  region._owner = true;
+
+  // The truncated file is zero filled, which is a valid state for every
+  // atomic field. The pid goes first so creators racing for the name see a
+  // live publisher
+  shm_stats_header& header = region.header();
+  header.publisher_pid.store(::getpid(), std::memory_order_relaxed);
+  header.reader_count = static_cast<std::uint32_t>(reader_count);
+  header.writer_count = static_cast<std::uint32_t>(writer_count);
+  header.histogram_bucket_count = histogram_buckets::BUCKET_COUNT;
+  header.capacity = capacity;
+  header.region_size = shape.size();
+  header.version = SHM_STATS_VERSION;
+  header.nanoseconds_per_tick.store(tsc_clock::to_nanoseconds(1),
+                                    std::memory_order_relaxed);
+
+  header.magic.store(SHM_STATS_MAGIC, std::memory_order_release);
+#else
+  static_cast<void>(name);
+  static_cast<void>(reader_count);
+  static_cast<void>(writer_count);
+  static_cast<void>(capacity);
+#endif
+
+  return region;
+}
+
+inline auto shm_stats_region::open(const std::string& name)
+    -> shm_stats_region
+{
+  shm_stats_region region;
+
+#ifdef __linux__
+  const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+  {
+    return region;
+  }
+
+  struct stat file_status
+  {
+  };
+  const bool large_enough = ::fstat(fd, &file_status) == 0 &&
+                            static_cast<std::size_t>(file_status.st_size) >=
+                                sizeof(shm_stats_header);
+
+  const auto size = static_cast<std::size_t>(file_status.st_size);
+  void* const address =
+      large_enough ? ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)
+                   : MAP_FAILED;
+  ::close(fd);
+
+  if (address == MAP_FAILED)
+  {
+    return region;
+  }
+
+  region._name = name;
+  region._address = address;
+  region._size = size;
+
+  const shm_stats_header& header = region.header();
+  const bool compatible =
+      header.magic.load(std::memory_order_acquire) == SHM_STATS_MAGIC &&
+      header.version == SHM_STATS_VERSION &&
+      header.histogram_bucket_count == histogram_buckets::BUCKET_COUNT &&
+      region.layout().size() <= region._size;
+
+  if (!compatible)
+  {
+    return shm_stats_region{};
+  }
+#else
+  static_cast<void>(name);
+#endif
+
+  return region;
+}
+
+// A region without a publisher pid may still be being created, so only a
+// pid that no longer names a process marks it as abandoned
+inline auto shm_stats_region::has_live_publisher(
+    const std::string& name) noexcept -> bool
+{
+#ifdef __linux__
+  const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+  {
+    return errno != ENOENT;
+  }
+
+  struct stat file_status
+  {
+  };
+  const bool large_enough = ::fstat(fd, &file_status) == 0 &&
+                            static_cast<std::size_t>(file_status.st_size) >=
+                                sizeof(shm_stats_header);
+
+  void* const address =
+      large_enough ? ::mmap(nullptr, sizeof(shm_stats_header), PROT_READ,
+                            MAP_SHARED, fd, 0)
+                   : MAP_FAILED;
+  ::close(fd);
+
+  if (address == MAP_FAILED)
+  {
+    return true;
+  }
+
+  const auto pid = static_cast<pid_t>(
+      static_cast<const shm_stats_header*>(address)->publisher_pid.load(
+          std::memory_order_relaxed));
+  ::munmap(address, sizeof(shm_stats_header));
+
+  return pid == 0 || ::kill(pid, 0) == 0 || errno == EPERM;
+#else
+  static_cast<void>(name);
+  return true;
+#endif
+}
+
+inline shm_stats_region::~shm_stats_region()
+{
+#ifdef __linux__
+  if (_address != nullptr)
+  {
+    ::munmap(_address, _size);
+
+    if (_owner)
+    {
+      ::shm_unlink(_name.c_str());
+    }
+  }
+#endif
+}
+
+inline shm_stats_region::shm_stats_region(shm_stats_region&& other) noexcept
+    : _name{std::move(other._name)},
+      _address{std::exchange(other._address, nullptr)},
+      _size{std::exchange(other._size, 0)},
+      _owner{std::exchange(other._owner, false)}
+{
+}
+
+inline auto shm_stats_region::operator=(shm_stats_region&& other) noexcept
+    -> shm_stats_region&
+{
+  if (this != &other)
+  {
+    shm_stats_region discarded{std::move(*this)};
+    _name = std::move(other._name);
+    _address = std::exchange(other._address, nullptr);
+    _size = std::exchange(other._size, 0);
+    _owner = std::exchange(other._owner, false);
+  }
+
+  return *this;
+}
+
+inline auto shm_stats_region::valid() const noexcept -> bool
+{
+  return _address != nullptr;
+}
+
+inline auto shm_stats_region::header() const noexcept -> shm_stats_header&
+{
+  return *static_cast<shm_stats_header*>(_address);
+}
+
+inline auto shm_stats_region::reader(const std::size_t index) const noexcept
+    -> shm_reader_stats&
+{
+  return reinterpret_cast<shm_reader_stats*>(
+      at(layout().readers_offset()))[index];
+}
+
+inline auto shm_stats_region::writer(const std::size_t index) const noexcept
+    -> shm_writer_stats&
+{
+  return reinterpret_cast<shm_writer_stats*>(
+      at(layout().writers_offset()))[index];
+}
+
+inline auto shm_stats_region::histogram(
+    const std::size_t reader_index) const noexcept
+    -> std::atomic<std::uint64_t>*
+{
+  return reinterpret_cast<std::atomic<std::uint64_t>*>(
+             at(layout().histograms_offset())) +
+         reader_index * histogram_buckets::BUCKET_COUNT;
+}
+
+inline auto shm_stats_region::histogram_snapshot_of(
+    const std::size_t reader_index) const -> histogram_snapshot
+{
+  const std::atomic<std::uint64_t>* const buckets = histogram(reader_index);
+  std::vector<std::uint64_t> counts(histogram_buckets::BUCKET_COUNT);
+
+  for (std::size_t i = 0; i < counts.size(); ++i)
+  {
+    counts[i] = buckets[i].load(std::memory_order_relaxed);
+  }
+
+  return histogram_snapshot{std::move(counts)};
+}
+
+inline auto shm_stats_region::layout() const noexcept -> shm_stats_layout
+{
+  return {header().reader_count, header().writer_count};
+}
+
+inline auto shm_stats_region::at(const std::size_t offset) const noexcept
+    -> std::byte*
+{
+  return static_cast<std::byte*>(_address) + offset;
+}
+
+// Mirrors a running queue into a shared-memory statistics region from a
+// background thread, every refresh interval. The queue's own threads never
+// touch the region, so its hot path is unchanged; instrumentation counters
+// and latency histograms are copied when the queue's policy provides them.
+// The queue must have started and must outlive the publisher
+template <typename QUEUE>
+class shm_stats_publisher
+{
+ public:
+  shm_stats_publisher(QUEUE& queue, const std::string& name,
+                      std::chrono::milliseconds refresh_interval =
+                          std::chrono::milliseconds(100));
+  ~shm_stats_publisher();
+
+  shm_stats_publisher(const shm_stats_publisher&) = delete;
+  shm_stats_publisher& operator=(const shm_stats_publisher&) = delete;
+
+  // False if the region could not be created, in which case nothing is
+  // published
+  [[nodiscard]] bool valid() const noexcept;
+
+  // Publishes immediately, on the calling thread
+  void refresh();
+
+ private:
+  void run();
+
+  QUEUE& _queue;
+  const std::chrono::milliseconds _refresh_interval;
+  shm_stats_region _region;
+  std::mutex _refresh_mutex;
+
+  std::mutex _stop_mutex;
+  std::condition_variable _stop_condition;
+  bool _stop{false};
+  std::thread _thread;
+};
+
+namespace internal
+{
+
+template <typename QUEUE>
+std::size_t count_readers(const QUEUE& queue)
+{
+  std::size_t count = 0;
+  queue.for_each_reader([&](const auto& /*reader*/) { ++count; });
+  return count;
+}
+
+template <typename QUEUE>
+std::size_t count_writers(const QUEUE& queue)
+{
+  std::size_t count = 0;
+  queue.for_each_writer([&](const auto& /*writer*/) { ++count; });
+  return count;
+}
+
+}  // namespace internal
+
+template <typename QUEUE>
+shm_stats_publisher<QUEUE>::shm_stats_publisher(
+    QUEUE& queue, const std::string& name,
+    const std::chrono::milliseconds refresh_interval)
+    : _queue{queue},
+      _refresh_interval{refresh_interval},
+      _region{shm_stats_region::create(name, internal::count_readers(queue),
+                                       internal::count_writers(queue),
+                                       QUEUE::capacity())}
+{
+  if (_region.valid())
+  {
+    refresh();
+    _thread = std::thread([this]() { run(); });
+  }
+}
+
+template <typename QUEUE>
+shm_stats_publisher<QUEUE>::~shm_stats_publisher()
+{
+  {
+    std::lock_guard<std::mutex> lock(_stop_mutex);
+    _stop = true;
+  }
+  _stop_condition.notify_one();
+
+  if (_thread.joinable())
+  {
+    _thread.join();
+  }
+}
+
+template <typename QUEUE>
+auto shm_stats_publisher<QUEUE>::valid() const noexcept -> bool
+{
+  return _region.valid();
+}
+
+template <typename QUEUE>
+auto shm_stats_publisher<QUEUE>::run() -> void
+{
+  std::unique_lock<std::mutex> lock(_stop_mutex);
+
+  while (!_stop_condition.wait_for(lock, _refresh_interval,
+                                   [this]() { return _stop; }))
+  {
+    lock.unlock();
+    refresh();
+    lock.lock();
+  }
+}
+
+template <typename QUEUE>
+auto shm_stats_publisher<QUEUE>::refresh() -> void
+{
+  if (!_region.valid())
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(_refresh_mutex);
+  constexpr auto relaxed = std::memory_order_relaxed;
+
+  const queue_statistics stats = _queue.statistics();
+  shm_stats_header& header = _region.header();
+
+  header.claimed_cursor.store(stats.claimed_cursor, relaxed);
+  header.published_cursor.store(stats.published_cursor, relaxed);
+
+  std::size_t index = 0;
+  _queue.for_each_reader([&](const auto& reader) {
+    shm_reader_stats& shared = _region.reader(index);
+    shared.sequence.store(stats.readers[index].sequence, relaxed);
+    shared.lag.store(stats.readers[index].lag, relaxed);
+
+    const auto& counters = reader.counters();
+    if constexpr (requires { counters.batched_events.load(); })
+    {
+      shared.wait_spins.store(counters.wait_spins.load(), relaxed);
+      shared.waits.store(counters.waits.load(), relaxed);
+      shared.batches.store(counters.batches.load(), relaxed);
+      shared.batched_events.store(counters.batched_events.load(), relaxed);
+    }
+
+    if constexpr (requires { counters.latency.snapshot(); })
+    {
+      const histogram_snapshot latency = counters.latency.snapshot();
+      std::atomic<std::uint64_t>* const buckets = _region.histogram(index);
+
+      for (std::size_t i = 0; i < latency.counts().size(); ++i)
+      {
+        buckets[i].store(latency.counts()[i], relaxed);
+      }
+    }
+
+    ++index;
+  });
+
+  index = 0;
+  _queue.for_each_writer([&](const auto& writer) {
+    shm_writer_stats& shared = _region.writer(index);
+    shared.wrap_stalls.store(stats.writers[index].wrap_stalls, relaxed);
+    shared.dropped.store(stats.writers[index].dropped, relaxed);
+
+    const auto& counters = writer.counters();
+    if constexpr (requires { counters.wrap_rescans.load(); })
+    {
+      shared.claim_retries.store(counters.claim_retries.load(), relaxed);
+      shared.wrap_rescans.store(counters.wrap_rescans.load(), relaxed);
+    }
+
+    ++index;
+  });
+
+  header.updated_ns.store(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count(),
+      relaxed);
+  header.updates.store(header.updates.load(relaxed) + 1, relaxed);
+}
+
+}  // namespace dq
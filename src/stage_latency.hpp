@@ -0,0 +1,325 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "bit_utils.hpp"
+#include "latency_histogram.hpp"
+#include "tsc_clock.hpp"
+
+namespace dq
+{
+
+struct stage_latency
+{
+  // From the previous stage's exit (or the source's publish) to entry, ticks
+  histogram_snapshot queueing;
+  // From entry to exit, ticks
+  histogram_snapshot service;
+  // Means over the events at or above the report's tail threshold, ns
+  double tail_queueing_ns;
+  double tail_service_ns;
+};
+
+template <std::size_t STAGES>
+struct stage_latency_report
+{
+  double percentile;
+  histogram_snapshot end_to_end;
+  std::uint64_t tail_threshold_ticks;
+  std::size_t tail_events;
+  std::array<stage_latency, STAGES> stages;
+
+  // One line per stage showing its share of the tail
+  [[nodiscard]] std::string to_string() const;
+};
+
+// Attributes the end-to-end latency of a pipeline of STAGES stages, joined by
+// queues, to queueing and service time per stage. Only every
+// sample_interval-th event id is traced. Events are identified by an id the
+// pipeline carries along, e.g. the source's sequence number.
+//
+// Each hook is called by the thread that owns that step and writes only its own
+// timestamps. Stages must call on_exit before publishing the event downstream
+// so the queues' release/acquire ordering makes the timestamps visible to the
+// last stage, which assembles the breakdown and owns the histograms
+template <std::size_t STAGES>
+class stage_latency_tracer
+{
+  static_assert(STAGES > 0, "A pipeline needs at least one stage");
+
+ public:
+  // Sampled events that may be in flight at once
+  static constexpr std::size_t TRACE_CAPACITY = 1024;
+  // Completed breakdowns kept for tail attribution
+  static constexpr std::size_t BREAKDOWN_CAPACITY = 16384;
+
+  explicit stage_latency_tracer(std::uint64_t sample_interval);
+
+  [[nodiscard]] bool is_sampled(std::uint64_t event_id) const noexcept;
+
+  void on_publish(std::uint64_t event_id) noexcept;
+  void on_entry(std::size_t stage, std::uint64_t event_id) noexcept;
+  void on_exit(std::size_t stage, std::uint64_t event_id) noexcept;
+
+  // Safe to call from any thread. Breakdowns being overwritten while the
+  // report reads them may be torn, which only blurs the tail attribution
+  [[nodiscard]] stage_latency_report<STAGES> report(
+      double percentile = 99.9) const;
+
+ private:
+  // Timestamps of one sampled event: the publish, then entry and exit per stage
+  static constexpr std::size_t STAMP_COUNT = 1 + 2 * STAGES;
+
+  struct trace
+  {
+    std::array<std::atomic<std::uint64_t>, STAMP_COUNT> stamps{};
+  };
+
+  // End to end, then queueing and service per stage, all in ticks
+  struct breakdown
+  {
+    std::array<std::atomic<std::uint64_t>, STAMP_COUNT> durations{};
+  };
+
+  trace& trace_for(std::uint64_t event_id) noexcept;
+  void complete(const trace& event_trace) noexcept;
+
+  static std::uint64_t elapsed(std::uint64_t from, std::uint64_t to) noexcept;
+
+  const std::uint64_t _sample_mask;
+
+  std::unique_ptr<std::array<trace, TRACE_CAPACITY>> _traces;
+
+  // Written by the last stage only
+  latency_histogram _end_to_end;
+  std::array<latency_histogram, STAGES> _queueing;
+  std::array<latency_histogram, STAGES> _service;
+  std::unique_ptr<std::array<breakdown, BREAKDOWN_CAPACITY>> _breakdowns;
+  std::atomic<std::uint64_t> _completed{0};
+};
+
+template <std::size_t STAGES>
+stage_latency_tracer<STAGES>::stage_latency_tracer(
+    const std::uint64_t sample_interval)
+    : _sample_mask{sample_interval - 1},
+      _traces{std::make_unique<std::array<trace, TRACE_CAPACITY>>()},
+      _breakdowns{std::make_unique<std::array<breakdown, BREAKDOWN_CAPACITY>>()}
+{
+  assert(internal::is_power_of_two(sample_interval) &&
+         "Sample interval must be a power of two");
+}
+
+template <std::size_t STAGES>
+auto stage_latency_tracer<STAGES>::is_sampled(
+    const std::uint64_t event_id) const noexcept -> bool
+{
+  return (event_id & _sample_mask) == 0;
+}
+
+template <std::size_t STAGES>
+auto stage_latency_tracer<STAGES>::on_publish(
+    const std::uint64_t event_id) noexcept -> void
+{
+  if (is_sampled(event_id))
+  {
+    trace_for(event_id).stamps[0].store(tsc_clock::now(),
+                                        std::memory_order_relaxed);
+  }
+}
+
+template <std::size_t STAGES>
+auto stage_latency_tracer<STAGES>::on_entry(
+    const std::size_t stage, const std::uint64_t event_id) noexcept -> void
+{
+  if (is_sampled(event_id))
+  {
+    trace_for(event_id).stamps[1 + 2 * stage].store(tsc_clock::now(),
+                                                    std::memory_order_relaxed);
+  }
+}
+
+template <std::size_t STAGES>
+auto stage_latency_tracer<STAGES>::on_exit(
+    const std::size_t stage, const std::uint64_t event_id) noexcept -> void
+{
+  if (!is_sampled(event_id))
+  {
+    return;
+  }
+
+  trace& event_trace = trace_for(event_id);
+  event_trace.stamps[2 + 2 * stage].store(tsc_clock::now(),
+                                          std::memory_order_relaxed);
+
+  if (stage + 1 == STAGES)
+  {
+    complete(event_trace);
+  }
+}
+
+template <std::size_t STAGES>
+auto stage_latency_tracer<STAGES>::trace_for(
+    const std::uint64_t event_id) noexcept -> trace&
+{
+  const std::uint64_t sample = event_id / (_sample_mask + 1);
+  return (*_traces)[sample % TRACE_CAPACITY];
+}
+
+template <std::size_t STAGES>
+auto stage_latency_tracer<STAGES>::complete(const trace& event_trace) noexcept
+    -> void
+{
+  std::array<std::uint64_t, STAMP_COUNT> stamps{};
+  for (std::size_t i = 0; i < STAMP_COUNT; ++i)
+  {
+    stamps[i] = event_trace.stamps[i].load(std::memory_order_relaxed);
+  }
+
+  const std::uint64_t completed = _completed.load(std::memory_order_relaxed);
+  breakdown& record = (*_breakdowns)[completed % BREAKDOWN_CAPACITY];
+
+  const std::uint64_t end_to_end = elapsed(stamps[0], stamps[STAMP_COUNT - 1]);
+  _end_to_end.record(end_to_end);
+  record.durations[0].store(end_to_end, std::memory_order_relaxed);
+
+  for (std::size_t stage = 0; stage < STAGES; ++stage)
+  {
+    const std::uint64_t queueing =
+        elapsed(stamps[2 * stage], stamps[1 + 2 * stage]);
+    const std::uint64_t service =
+        elapsed(stamps[1 + 2 * stage], stamps[2 + 2 * stage]);
+
+    _queueing[stage].record(queueing);
+    _service[stage].record(service);
+    record.durations[1 + 2 * stage].store(queueing, std::memory_order_relaxed);
+    record.durations[2 + 2 * stage].store(service, std::memory_order_relaxed);
+  }
+
+  _completed.store(completed + 1, std::memory_order_release);
+}
+
+template <std::size_t STAGES>
+auto stage_latency_tracer<STAGES>::elapsed(const std::uint64_t from,
+                                           const std::uint64_t to) noexcept
+    -> std::uint64_t
+{
+  return to > from ? to - from : 0;
+}
+
+template <std::size_t STAGES>
+auto stage_latency_tracer<STAGES>::report(const double percentile) const
+    -> stage_latency_report<STAGES>
+{
+  stage_latency_report<STAGES> result{};
+  result.percentile = percentile;
+  result.end_to_end = _end_to_end.snapshot();
+  result.tail_threshold_ticks =
+      result.end_to_end.value_at_percentile(percentile);
+
+  for (std::size_t stage = 0; stage < STAGES; ++stage)
+  {
+    result.stages[stage].queueing = _queueing[stage].snapshot();
+    result.stages[stage].service = _service[stage].snapshot();
+  }
+
+  const std::uint64_t completed = _completed.load(std::memory_order_acquire);
+  const std::uint64_t available =
+      std::min<std::uint64_t>(completed, BREAKDOWN_CAPACITY);
+
+  std::array<double, STAMP_COUNT> tail_sums{};
+
+  for (std::uint64_t i = completed - available; i < completed; ++i)
+  {
+    const breakdown& record = (*_breakdowns)[i % BREAKDOWN_CAPACITY];
+
+    // Histogram buckets report their highest equivalent value, so compare
+    // bucket to bucket
+    const std::uint64_t end_to_end =
+        record.durations[0].load(std::memory_order_relaxed);
+    if (histogram_buckets::highest_value(histogram_buckets::index_of(
+            end_to_end)) < result.tail_threshold_ticks)
+    {
+      continue;
+    }
+
+    ++result.tail_events;
+    for (std::size_t j = 0; j < STAMP_COUNT; ++j)
+    {
+      tail_sums[j] += static_cast<double>(
+          record.durations[j].load(std::memory_order_relaxed));
+    }
+  }
+
+  if (result.tail_events != 0)
+  {
+    const auto events = static_cast<double>(result.tail_events);
+    const double ns_per_tick = tsc_clock::to_nanoseconds(1);
+
+    for (std::size_t stage = 0; stage < STAGES; ++stage)
+    {
+      result.stages[stage].tail_queueing_ns =
+          tail_sums[1 + 2 * stage] / events * ns_per_tick;
+      result.stages[stage].tail_service_ns =
+          tail_sums[2 + 2 * stage] / events * ns_per_tick;
+    }
+  }
+
+  return result;
+}
+
+template <std::size_t STAGES>
+auto stage_latency_report<STAGES>::to_string() const -> std::string
+{
+  const auto ns = [](const std::uint64_t ticks) {
+    return tsc_clock::to_nanoseconds(ticks);
+  };
+
+  double tail_total_ns = 0.0;
+  for (const stage_latency& stage : stages)
+  {
+    tail_total_ns += stage.tail_queueing_ns + stage.tail_service_ns;
+  }
+
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(1);
+  out << "end-to-end: samples=" << end_to_end.total_count()
+      << " p50=" << ns(end_to_end.value_at_percentile(50.0)) << "ns"
+      << " p" << percentile << "=" << ns(tail_threshold_ticks) << "ns"
+      << " max=" << ns(end_to_end.max()) << "ns"
+      << " tail_events=" << tail_events << '\n';
+
+  for (std::size_t i = 0; i < STAGES; ++i)
+  {
+    const stage_latency& stage = stages[i];
+    const double share =
+        tail_total_ns > 0.0
+            ? 100.0 * (stage.tail_queueing_ns + stage.tail_service_ns) /
+                  tail_total_ns
+            : 0.0;
+
+    out << "stage " << i << ": queueing p50="
+        << ns(stage.queueing.value_at_percentile(50.0)) << "ns"
+        << " p" << percentile << "="
+        << ns(stage.queueing.value_at_percentile(percentile)) << "ns"
+        << " service p50=" << ns(stage.service.value_at_percentile(50.0))
+        << "ns"
+        << " p" << percentile << "="
+        << ns(stage.service.value_at_percentile(percentile)) << "ns"
+        << " | tail queueing=" << stage.tail_queueing_ns << "ns"
+        << " service=" << stage.tail_service_ns << "ns"
+        << " share=" << share << "%\n";
+  }
+
+  return out.str();
+}
+
+}  // namespace dq
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "queue_statistics.hpp"
+
+namespace dq
+{
+
+struct stall_report
+{
+  std::size_t reader_index;
+  std::int64_t reader_sequence;
+  // Published events the reader has not consumed yet
+  std::int64_t lag;
+  // Since the reader last advanced, as seen by the watchdog's samples
+  std::chrono::nanoseconds stalled_for;
+  // Whether a writer has claimed a slot that waits on this reader
+  bool gating_writer;
+};
+
+// Samples a running queue's statistics from a background thread and reports
+// readers that have events to consume but have not advanced for at least the
+// threshold. A writer stuck in wait_for_no_wrap shows up as a report for the
+// slowest reader with gating_writer set. Each stall is reported once, when it
+// crosses the threshold; the reader must advance before it is reported again.
+//
+// Only reads what statistics() already exposes, so the hot path is unchanged.
+// The queue must have started and must outlive the watchdog
+template <typename QUEUE>
+class stall_watchdog
+{
+ public:
+  using clock = std::chrono::steady_clock;
+  // Invoked on the watchdog thread
+  using callback_type = std::function<void(const stall_report&)>;
+
+  stall_watchdog(QUEUE& queue, clock::duration threshold,
+                 callback_type on_stall);
+  stall_watchdog(QUEUE& queue, clock::duration threshold,
+                 callback_type on_stall, clock::duration poll_interval);
+  ~stall_watchdog();
+
+  stall_watchdog(const stall_watchdog&) = delete;
+  stall_watchdog& operator=(const stall_watchdog&) = delete;
+
+  [[nodiscard]] std::uint64_t stalls_reported() const noexcept;
+
+ private:
+  struct reader_progress
+  {
+    std::int64_t sequence{std::numeric_limits<std::int64_t>::min()};
+    clock::time_point since{};
+    bool reported{false};
+  };
+
+  void run();
+  void check(clock::time_point now);
+
+  QUEUE& _queue;
+  const clock::duration _threshold;
+  const clock::duration _poll_interval;
+  const callback_type _on_stall;
+
+  std::vector<reader_progress> _progress{};
+  std::atomic<std::uint64_t> _stalls_reported{0};
+
+  std::mutex _stop_mutex;
+  std::condition_variable _stop_condition;
+  bool _stop{false};
+  std::thread _thread;
+};
+
+template <typename QUEUE>
+stall_watchdog<QUEUE>::stall_watchdog(QUEUE& queue,
+                                      const clock::duration threshold,
+                                      callback_type on_stall)
+    : stall_watchdog(queue, threshold, std::move(on_stall),
+                     std::max<clock::duration>(threshold / 4,
+                                               std::chrono::microseconds(100)))
+{
+}
+
+template <typename QUEUE>
+stall_watchdog<QUEUE>::stall_watchdog(QUEUE& queue,
+                                      const clock::duration threshold,
+                                      callback_type on_stall,
+                                      const clock::duration poll_interval)
+    : _queue{queue},
+      _threshold{threshold},
+      _poll_interval{poll_interval},
+      _on_stall{std::move(on_stall)},
+      _thread{[this]() { run(); }}
+{
+}
+
+template <typename QUEUE>
+stall_watchdog<QUEUE>::~stall_watchdog()
+{
+  {
+    std::lock_guard<std::mutex> lock(_stop_mutex);
+    _stop = true;
+  }
+  _stop_condition.notify_one();
+  _thread.join();
+}
+
+template <typename QUEUE>
+auto stall_watchdog<QUEUE>::stalls_reported() const noexcept -> std::uint64_t
+{
+  return _stalls_reported.load(std::memory_order_relaxed);
+}
+
+template <typename QUEUE>
+auto stall_watchdog<QUEUE>::run() -> void
+{
+  std::unique_lock<std::mutex> lock(_stop_mutex);
+
+  while (!_stop)
+  {
+    lock.unlock();
+    check(clock::now());
+    lock.lock();
+
+    _stop_condition.wait_for(lock, _poll_interval, [this]() { return _stop; });
+  }
+}
+
+template <typename QUEUE>
+auto stall_watchdog<QUEUE>::check(const clock::time_point now) -> void
+{
+  const queue_statistics stats = _queue.statistics();
+  _progress.resize(stats.readers.size());
+
+  std::int64_t min_sequence = std::numeric_limits<std::int64_t>::max();
+  for (const reader_statistics& reader : stats.readers)
+  {
+    min_sequence = std::min(min_sequence, reader.sequence);
+  }
+
+  // A blocking writer claims before it waits, so its claim runs more than a
+  // full ring ahead of the slowest reader
+  const bool writer_blocked =
+      !stats.readers.empty() &&
+      stats.claimed_cursor - min_sequence >
+          static_cast<std::int64_t>(QUEUE::capacity());
+
+  for (std::size_t i = 0; i < stats.readers.size(); ++i)
+  {
+    const reader_statistics& reader = stats.readers[i];
+    reader_progress& progress = _progress[i];
+
+    if (reader.sequence != progress.sequence)
+    {
+      progress = {reader.sequence, now, false};
+      continue;
+    }
+
+    const bool waiting_on_reader =
+        reader.lag > 0 || (writer_blocked && reader.sequence == min_sequence);
+
+    if (!waiting_on_reader)
+    {
+      // An idle reader is not stalled; start timing once work arrives
+      progress.since = now;
+      continue;
+    }
+
+    if (!progress.reported && now - progress.since >= _threshold)
+    {
+      progress.reported = true;
+      _stalls_reported.fetch_add(1, std::memory_order_relaxed);
+
+      if (_on_stall)
+      {
+        _on_stall({i, reader.sequence, reader.lag, now - progress.since,
+                   writer_blocked && reader.sequence == min_sequence});
+      }
+    }
+  }
+}
+
+}  // namespace dq
@@ -0,0 +1,524 @@
+#include "thread_placement.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace dq
+{
+
+namespace
+{
+
+constexpr int UNKNOWN = -1;
+
+std::optional<std::string> read_line(const std::filesystem::path& path)
+{
+  std::ifstream file(path);
+  std::string line;
+
+  if (!file || !std::getline(file, line))
+  {
+    return std::nullopt;
+  }
+
+  return line;
+}
+
+int read_int(const std::filesystem::path& path, const int fallback)
+{
+  const std::optional<std::string> line = read_line(path);
+  int value = fallback;
+
+  if (line)
+  {
+    std::from_chars(line->data(), line->data() + line->size(), value);
+  }
+
+  return value;
+}
+
+std::vector<int> online_cpus(const std::filesystem::path& root)
+{
+  if (const std::optional<std::string> online = read_line(root / "online"))
+  {
+    return parse_cpu_list(*online);
+  }
+
+  // Fall back to the cpuN directories
+  std::vector<int> cpus;
+  std::error_code error;
+
+  for (const auto& entry : std::filesystem::directory_iterator(root, error))
+  {
+    const std::string name = entry.path().filename().string();
+    int cpu = UNKNOWN;
+
+    if (name.rfind("cpu", 0) == 0 &&
+        std::from_chars(name.data() + 3, name.data() + name.size(), cpu).ec ==
+            std::errc{})
+    {
+      cpus.push_back(cpu);
+    }
+  }
+
+  std::sort(cpus.begin(), cpus.end());
+  return cpus;
+}
+
+// Lowest CPU sharing the data or unified cache at level with cpu
+int cache_group(const std::filesystem::path& cpu_path, const int level)
+{
+  std::error_code error;
+
+  for (const auto& entry :
+       std::filesystem::directory_iterator(cpu_path / "cache", error))
+  {
+    if (entry.path().filename().string().rfind("index", 0) != 0 ||
+        read_int(entry.path() / "level", UNKNOWN) != level ||
+        read_line(entry.path() / "type") == "Instruction")
+    {
+      continue;
+    }
+
+    const std::optional<std::string> shared =
+        read_line(entry.path() / "shared_cpu_list");
+    const std::vector<int> cpus =
+        shared ? parse_cpu_list(*shared) : std::vector<int>{};
+
+    if (!cpus.empty())
+    {
+      return cpus.front();
+    }
+  }
+
+  return UNKNOWN;
+}
+
+// Every CPU, interleaving L3 groups and, within a group, taking one CPU per
+// core before any SMT sibling
+std::vector<int> spread_order(const cpu_topology& topology)
+{
+  std::map<int, std::vector<int>> groups;
+  std::map<int, std::vector<int>> siblings;
+  std::map<std::pair<int, int>, bool> seen_cores;
+
+  for (const cpu_info& cpu : topology.cpus())
+  {
+    const bool first_on_core =
+        !std::exchange(seen_cores[{cpu.package_id, cpu.core_id}], true);
+    (first_on_core ? groups : siblings)[cpu.l3_group].push_back(cpu.cpu);
+  }
+
+  for (auto& [group, cpus] : siblings)
+  {
+    groups[group].insert(groups[group].end(), cpus.begin(), cpus.end());
+  }
+
+  std::vector<int> order;
+
+  for (std::size_t i = 0; order.size() < topology.cpus().size(); ++i)
+  {
+    for (const auto& [group, cpus] : groups)
+    {
+      if (i < cpus.size())
+      {
+        order.push_back(cpus[i]);
+      }
+    }
+  }
+
+  return order;
+}
+
+// The tightest policy the chosen CPUs satisfy
+placement_policy classify(const cpu_topology& topology,
+                          const std::vector<int>& cpus)
+{
+  if (cpus.empty() ||
+      std::find(cpus.begin(), cpus.end(), UNKNOWN) != cpus.end())
+  {
+    return placement_policy::unpinned;
+  }
+
+  const auto all_share = [&](int cpu_info::*group) {
+    return std::all_of(cpus.begin(), cpus.end(), [&](const int cpu) {
+      return topology.find(cpu)->*group == topology.find(cpus[0])->*group;
+    });
+  };
+
+  if (all_share(&cpu_info::l2_group))
+  {
+    return placement_policy::shared_l2;
+  }
+
+  if (all_share(&cpu_info::l3_group))
+  {
+    return placement_policy::shared_l3;
+  }
+
+  return placement_policy::separate_l3;
+}
+
+std::vector<int> take(const std::vector<int>& candidates,
+                      const std::size_t threads)
+{
+  std::vector<int> cpus(candidates.begin(),
+                        candidates.begin() + static_cast<std::ptrdiff_t>(
+                                                 std::min(threads,
+                                                          candidates.size())));
+  cpus.resize(threads, UNKNOWN);
+  return cpus;
+}
+
+// The first group's CPUs, in spread order, that has room for every thread
+std::optional<std::vector<int>> within_group(const cpu_topology& topology,
+                                             const std::size_t threads,
+                                             int cpu_info::*group)
+{
+  std::map<int, std::vector<int>> groups;
+
+  for (const int cpu : spread_order(topology))
+  {
+    groups[topology.find(cpu)->*group].push_back(cpu);
+  }
+
+  for (const auto& [id, cpus] : groups)
+  {
+    if (cpus.size() >= threads)
+    {
+      return take(cpus, threads);
+    }
+  }
+
+  return std::nullopt;
+}
+
+}  // namespace
+
+auto parse_cpu_list(const std::string_view list) -> std::vector<int>
+{
+  std::vector<int> cpus;
+  std::size_t position = 0;
+
+  while (position < list.size())
+  {
+    const std::size_t end = std::min(list.find(',', position), list.size());
+    const std::string_view range = list.substr(position, end - position);
+    position = end + 1;
+
+    if (range.empty())
+    {
+      continue;
+    }
+
+    int first = 0;
+    int last = 0;
+    const char* const range_end = range.data() + range.size();
+    std::from_chars_result parsed =
+        std::from_chars(range.data(), range_end, first);
+    last = first;
+
+    if (parsed.ec == std::errc{} && parsed.ptr != range_end &&
+        *parsed.ptr == '-')
+    {
+      parsed = std::from_chars(parsed.ptr + 1, range_end, last);
+    }
+
+    if (parsed.ec != std::errc{} || parsed.ptr != range_end || last < first)
+    {
+      return {};
+    }
+
+    for (int cpu = first; cpu <= last; ++cpu)
+    {
+      cpus.push_back(cpu);
+    }
+  }
+
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+auto cpu_topology::detect() -> cpu_topology
+{
+  std::vector<int> allowed;
+
+#ifdef __linux__
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+
+  if (::sched_getaffinity(0, sizeof(mask), &mask) == 0)
+  {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+      if (CPU_ISSET(cpu, &mask))
+      {
+        allowed.push_back(cpu);
+      }
+    }
+  }
+#endif
+
+  return from_sysfs("/sys/devices/system/cpu", allowed);
+}
+
+auto cpu_topology::from_sysfs(const std::string& root,
+                              const std::vector<int>& allowed_cpus)
+    -> cpu_topology
+{
+  const std::filesystem::path root_path(root);
+  cpu_topology topology;
+
+  for (const int cpu : online_cpus(root_path))
+  {
+    if (!allowed_cpus.empty() &&
+        std::find(allowed_cpus.begin(), allowed_cpus.end(), cpu) ==
+            allowed_cpus.end())
+    {
+      continue;
+    }
+
+    const std::filesystem::path cpu_path =
+        root_path / ("cpu" + std::to_string(cpu));
+
+    topology._cpus.push_back(
+        {cpu, read_int(cpu_path / "topology" / "core_id", cpu),
+         read_int(cpu_path / "topology" / "physical_package_id", 0),
+         cache_group(cpu_path, 2), cache_group(cpu_path, 3)});
+  }
+
+  // Without cache information assume a private L2 per core and an L3 per
+  // package, identified by their lowest CPU
+  for (cpu_info& cpu : topology._cpus)
+  {
+    for (const cpu_info& other : topology._cpus)
+    {
+      if (cpu.l2_group == UNKNOWN && other.package_id == cpu.package_id &&
+          other.core_id == cpu.core_id)
+      {
+        cpu.l2_group = other.cpu;
+      }
+
+      if (cpu.l3_group == UNKNOWN && other.package_id == cpu.package_id)
+      {
+        cpu.l3_group = other.cpu;
+      }
+    }
+  }
+
+  return topology;
+}
+
+auto cpu_topology::cpus() const noexcept -> const std::vector<cpu_info>&
+{
+  return _cpus;
+}
+
+auto cpu_topology::find(const int cpu) const noexcept -> const cpu_info*
+{
+  const auto found =
+      std::find_if(_cpus.begin(), _cpus.end(),
+                   [&](const cpu_info& info) { return info.cpu == cpu; });
+
+  return found == _cpus.end() ? nullptr : &*found;
+}
+
+auto to_string(const placement_policy policy) noexcept -> const char*
+{
+  switch (policy)
+  {
+    case placement_policy::unpinned:
+      return "unpinned";
+    case placement_policy::shared_l2:
+      return "shared_l2";
+    case placement_policy::shared_l3:
+      return "shared_l3";
+    case placement_policy::separate_l3:
+      return "separate_l3";
+  }
+
+  return "unknown";
+}
+
+auto parse_placement_policy(const std::string_view name) noexcept
+    -> std::optional<placement_policy>
+{
+  for (const placement_policy policy :
+       {placement_policy::unpinned, placement_policy::shared_l2,
+        placement_policy::shared_l3, placement_policy::separate_l3})
+  {
+    if (name == to_string(policy))
+    {
+      return policy;
+    }
+  }
+
+  return std::nullopt;
+}
+
+auto plan_placement(const cpu_topology& topology, const std::size_t threads,
+                    const placement_policy policy) -> placement_plan
+{
+  std::optional<std::vector<int>> cpus;
+
+  switch (policy)
+  {
+    case placement_policy::unpinned:
+      cpus = std::vector<int>(threads, UNKNOWN);
+      break;
+    case placement_policy::shared_l2:
+      cpus = within_group(topology, threads, &cpu_info::l2_group);
+      if (cpus)
+      {
+        break;
+      }
+      [[fallthrough]];
+    case placement_policy::shared_l3:
+      cpus = within_group(topology, threads, &cpu_info::l3_group);
+      if (cpus)
+      {
+        break;
+      }
+      [[fallthrough]];
+    case placement_policy::separate_l3:
+      cpus = take(spread_order(topology), threads);
+      break;
+  }
+
+  const placement_policy achieved = policy == placement_policy::unpinned
+                                        ? placement_policy::unpinned
+                                        : classify(topology, *cpus);
+
+  return {policy, achieved, std::move(*cpus)};
+}
+
+auto placement_plan::to_string(const cpu_topology& topology) const
+    -> std::string
+{
+  std::ostringstream out;
+  out << "placement " << dq::to_string(requested) << " (achieved "
+      << dq::to_string(achieved) << "):";
+
+  for (std::size_t i = 0; i < cpus.size(); ++i)
+  {
+    out << " thread " << i << " -> ";
+    const cpu_info* const cpu = topology.find(cpus[i]);
+
+    if (cpu == nullptr)
+    {
+      out << "any";
+    }
+    else
+    {
+      out << "cpu " << cpu->cpu << " [package " << cpu->package_id
+          << " core " << cpu->core_id << " L2 " << cpu->l2_group << " L3 "
+          << cpu->l3_group << "]";
+    }
+
+    out << (i + 1 < cpus.size() ? ";" : "");
+  }
+
+  return out.str();
+}
+
+auto place_current_thread(const int cpu, const bool realtime,
+                          const int priority) -> placement_result
+{
+  placement_result result{cpu, false, false};
+
+#ifdef __linux__
+  if (cpu != UNKNOWN)
+  {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    result.pinned =
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(mask), &mask) == 0;
+  }
+
+  if (realtime)
+  {
+    sched_param parameters{};
+    parameters.sched_priority = priority;
+    result.realtime = ::pthread_setschedparam(::pthread_self(), SCHED_FIFO,
+                                              &parameters) == 0;
+  }
+#else
+  static_cast<void>(realtime);
+  static_cast<void>(priority);
+#endif
+
+  return result;
+}
+
+scoped_thread_placement::scoped_thread_placement(const int cpu,
+                                                 const bool realtime,
+                                                 const int priority)
+    : _result{cpu, false, false}
+{
+#ifdef __linux__
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+
+  if (::pthread_getaffinity_np(::pthread_self(), sizeof(mask), &mask) == 0)
+  {
+    for (int i = 0; i < CPU_SETSIZE; ++i)
+    {
+      if (CPU_ISSET(i, &mask))
+      {
+        _previous_cpus.push_back(i);
+      }
+    }
+  }
+
+  sched_param parameters{};
+  ::pthread_getschedparam(::pthread_self(), &_previous_policy, &parameters);
+  _previous_priority = parameters.sched_priority;
+#endif
+
+  _result = place_current_thread(cpu, realtime, priority);
+}
+
+scoped_thread_placement::~scoped_thread_placement()
+{
+#ifdef __linux__
+  if (_result.pinned && !_previous_cpus.empty())
+  {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+
+    for (const int cpu : _previous_cpus)
+    {
+      CPU_SET(cpu, &mask);
+    }
+
+    ::pthread_setaffinity_np(::pthread_self(), sizeof(mask), &mask);
+  }
+
+  if (_result.realtime)
+  {
+    sched_param parameters{};
+    parameters.sched_priority = _previous_priority;
+    ::pthread_setschedparam(::pthread_self(), _previous_policy, &parameters);
+  }
+#endif
+}
+
+auto scoped_thread_placement::result() const noexcept
+    -> const placement_result&
+{
+  return _result;
+}
+
+}  // namespace dq
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dq
+{
+
+// Parses a kernel CPU list such as "0-3,8,10-11". Returns an empty list if it
+// is malformed
+[[nodiscard]] std::vector<int> parse_cpu_list(std::string_view list);
+
+struct cpu_info
+{
+  int cpu;
+  int core_id;
+  int package_id;
+  // Lowest CPU sharing this CPU's L2/L3, identifying the cache. Falls back to
+  // the core (L2) or package (L3) when sysfs does not describe the cache
+  int l2_group;
+  int l3_group;
+};
+
+// Logical CPUs this process may run on, as described by
+// /sys/devices/system/cpu
+class cpu_topology
+{
+ public:
+  // The online CPUs in the calling thread's affinity mask
+  [[nodiscard]] static cpu_topology detect();
+  // For testing against a copy of the sysfs tree. An empty allowed list
+  // allows every online CPU
+  [[nodiscard]] static cpu_topology from_sysfs(
+      const std::string& root, const std::vector<int>& allowed_cpus);
+
+  [[nodiscard]] const std::vector<cpu_info>& cpus() const noexcept;
+  [[nodiscard]] const cpu_info* find(int cpu) const noexcept;
+
+ private:
+  std::vector<cpu_info> _cpus{};
+};
+
+enum class placement_policy
+{
+  // Leave every thread to the scheduler
+  unpinned,
+  // Threads on CPUs sharing an L2, usually SMT siblings of one core
+  shared_l2,
+  // Threads on distinct cores sharing an L3
+  shared_l3,
+  // Threads on different L3s (or packages) where available
+  separate_l3,
+};
+
+[[nodiscard]] const char* to_string(placement_policy policy) noexcept;
+[[nodiscard]] std::optional<placement_policy> parse_placement_policy(
+    std::string_view name) noexcept;
+
+struct placement_plan
+{
+  placement_policy requested;
+  // The policy the topology allowed; plans fall back to looser policies
+  placement_policy achieved;
+  // One CPU per thread, in the caller's role order, or -1 to leave the
+  // thread to the scheduler when there are fewer CPUs than threads
+  std::vector<int> cpus;
+
+  [[nodiscard]] std::string to_string(const cpu_topology& topology) const;
+};
+
+[[nodiscard]] placement_plan plan_placement(const cpu_topology& topology,
+                                            std::size_t threads,
+                                            placement_policy policy);
+
+struct placement_result
+{
+  int cpu;
+  bool pinned;
+  bool realtime;
+};
+
+// Pins the calling thread to cpu (unless it is -1) and, if requested, moves it
+// to SCHED_FIFO at the given priority. Each step that fails, e.g. for lack of
+// CAP_SYS_NICE, is reported as not done rather than as an error
+placement_result place_current_thread(int cpu, bool realtime = false,
+                                      int priority = 1);
+
+// Places the calling thread for the object's lifetime, then restores its
+// previous affinity and scheduling policy. Threads it starts meanwhile
+// inherit the placement
+class scoped_thread_placement
+{
+ public:
+  explicit scoped_thread_placement(int cpu, bool realtime = false,
+                                   int priority = 1);
+  ~scoped_thread_placement();
+
+  scoped_thread_placement(const scoped_thread_placement&) = delete;
+  scoped_thread_placement& operator=(const scoped_thread_placement&) = delete;
+
+  [[nodiscard]] const placement_result& result() const noexcept;
+
+ private:
+  std::vector<int> _previous_cpus{};
+  int _previous_policy{0};
+  int _previous_priority{0};
+  placement_result _result;
+};
+
+}  // namespace dq
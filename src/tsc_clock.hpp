@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if !defined(DQ_DISABLE_TSC) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <x86intrin.h>
+#define DQ_TSC_X86 1
+#elif !defined(DQ_DISABLE_TSC) && defined(__aarch64__)
+#define DQ_TSC_ARM64 1
+#endif
+
+namespace dq
+{
+
+// Ratio between tsc_clock ticks and nanoseconds, measured against
+// steady_clock
+struct tsc_calibration
+{
+  double ticks_per_ns;
+  // False when ticks are steady_clock nanoseconds rather than a hardware
+  // counter
+  bool hardware_counter;
+};
+
+// Cheapest available timestamp: the time-stamp counter on x86 when it is
+// invariant, the virtual counter on AArch64, steady_clock nanoseconds
+// elsewhere or when DQ_DISABLE_TSC is defined. Ticks are only comparable
+// within one machine and are converted to nanoseconds through calibration()
+class tsc_clock
+{
+ public:
+  static constexpr std::chrono::milliseconds CALIBRATION_PERIOD{20};
+
+  [[nodiscard]] static std::uint64_t now() noexcept;
+
+  // Spins for the given period comparing ticks with steady_clock
+  [[nodiscard]] static tsc_calibration calibrate(
+      std::chrono::nanoseconds period = CALIBRATION_PERIOD) noexcept;
+
+  // Calibrates on first use, which blocks for CALIBRATION_PERIOD
+  [[nodiscard]] static const tsc_calibration& calibration() noexcept;
+
+  [[nodiscard]] static double to_nanoseconds(std::uint64_t ticks) noexcept;
+
+  // Whether now() reads a hardware counter. An x86 TSC is only used when
+  // CPUID reports it invariant, ticking at a constant rate through frequency
+  // changes and sleep states
+  [[nodiscard]] static bool hardware_counter() noexcept;
+
+ private:
+  static bool detect_invariant_tsc() noexcept;
+  static std::uint64_t steady_nanoseconds() noexcept;
+};
+
+inline auto tsc_clock::now() noexcept -> std::uint64_t
+{
+#if defined(DQ_TSC_X86)
+  if (hardware_counter())
+  {
+    return __rdtsc();
+  }
+  return steady_nanoseconds();
+#elif defined(DQ_TSC_ARM64)
+  std::uint64_t ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return steady_nanoseconds();
+#endif
+}
+
+inline auto tsc_clock::calibrate(const std::chrono::nanoseconds period) noexcept
+    -> tsc_calibration
+{
+  if (!hardware_counter())
+  {
+    static_cast<void>(period);
+    return {1.0, false};
+  }
+
+  const std::uint64_t start_ns = steady_nanoseconds();
+  const std::uint64_t start_ticks = now();
+
+  std::uint64_t end_ns = start_ns;
+  while (end_ns - start_ns < static_cast<std::uint64_t>(period.count()))
+  {
+    end_ns = steady_nanoseconds();
+  }
+
+  const std::uint64_t end_ticks = now();
+
+  return {static_cast<double>(end_ticks - start_ticks) /
+              static_cast<double>(end_ns - start_ns),
+          true};
+}
+
+inline auto tsc_clock::calibration() noexcept -> const tsc_calibration&
+{
+  static const tsc_calibration calibrated = calibrate();
+  return calibrated;
+}
+
+inline auto tsc_clock::to_nanoseconds(const std::uint64_t ticks) noexcept
+    -> double
+{
+  return static_cast<double>(ticks) / calibration().ticks_per_ns;
+}
+
+inline auto tsc_clock::hardware_counter() noexcept -> bool
+{
+#if defined(DQ_TSC_X86)
+  static const bool invariant = detect_invariant_tsc();
+  return invariant;
+#elif defined(DQ_TSC_ARM64)
+  // The generic timer's counter is architecturally constant rate
+  return true;
+#else
+  return false;
+#endif
+}
+
+inline auto tsc_clock::detect_invariant_tsc() noexcept -> bool
+{
+#if defined(DQ_TSC_X86)
+  constexpr unsigned ADVANCED_POWER_LEAF = 0x80000007;
+  constexpr unsigned INVARIANT_TSC_BIT = 1U << 8;
+
+  unsigned eax = 0;
+  unsigned ebx = 0;
+  unsigned ecx = 0;
+  unsigned edx = 0;
+  if (__get_cpuid_max(0x80000000, nullptr) < ADVANCED_POWER_LEAF ||
+      __get_cpuid(ADVANCED_POWER_LEAF, &eax, &ebx, &ecx, &edx) == 0)
+  {
+    return false;
+  }
+
+  return (edx & INVARIANT_TSC_BIT) != 0;
+#else
+  return false;
+#endif
+}
+
+inline auto tsc_clock::steady_nanoseconds() noexcept -> std::uint64_t
+{
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+}  // namespace dq
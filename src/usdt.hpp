@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+// USDT (statically defined tracing) probes for perf, bpftrace and SystemTap,
+// enabled with -DDQ_ENABLE_USDT. Each probe is a single nop plus an ELF
+// .note.stapsdt entry describing where its arguments live, written out the
+// way <sys/sdt.h> does so there is no build or runtime dependency. Tracers
+// patch the nop when they attach, so an unattached probe costs the nop and
+// keeping its arguments in registers.
+//
+// Probes, all under the "dq" provider, with sequence arguments as int64:
+//   publish(sequence)                 writer made the slot visible
+//   consume(sequence)                 reader released the slot
+//   reader_wait_begin(sequence)       reader found the slot unpublished
+//   reader_wait_end(sequence)
+//   writer_wait_begin(sequence, min)  claim would wrap past the slowest reader
+//   writer_wait_end(sequence)
+//
+// e.g. bpftrace -e 'usdt:./binary:dq:publish { @[tid] = count(); }'
+
+#if defined(DQ_ENABLE_USDT) && defined(__ELF__) && \
+    (defined(__x86_64__) || defined(__aarch64__))
+
+#define DQ_USDT_STRINGIFY_(x) #x
+#define DQ_USDT_STRINGIFY(x) DQ_USDT_STRINGIFY_(x)
+
+// The note records the probe's address relative to _.stapsdt.base so tracers
+// can relocate it in position-independent binaries
+#define DQ_USDT_ASM_(name, arguments)                                        \
+  "990: nop\n"                                                               \
+  ".pushsection .note.stapsdt,\"?\",\"note\"\n"                              \
+  ".balign 4\n"                                                              \
+  ".4byte 992f-991f, 994f-993f, 3\n"                                         \
+  "991: .asciz \"stapsdt\"\n"                                                \
+  "992: .balign 4\n"                                                         \
+  "993: .8byte 990b\n"                                                       \
+  ".8byte _.stapsdt.base\n"                                                  \
+  ".8byte 0\n"                                                               \
+  ".asciz \"dq\"\n"                                                          \
+  ".asciz \"" DQ_USDT_STRINGIFY(name) "\"\n"                                 \
+  ".asciz \"" arguments "\"\n"                                               \
+  "994: .balign 4\n"                                                         \
+  ".popsection\n"                                                            \
+  ".ifndef _.stapsdt.base\n"                                                 \
+  ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"    \
+  ".weak _.stapsdt.base\n"                                                   \
+  ".hidden _.stapsdt.base\n"                                                 \
+  "_.stapsdt.base: .space 1\n"                                               \
+  ".size _.stapsdt.base, 1\n"                                                \
+  ".popsection\n"                                                            \
+  ".endif\n"
+
+#define DQ_USDT_PROBE1(name, first)                                 \
+  __asm__ __volatile__(DQ_USDT_ASM_(name, "-8@%0")                  \
+                       :                                            \
+                       : "nor"(static_cast<std::int64_t>(first)))
+
+#define DQ_USDT_PROBE2(name, first, second)                         \
+  __asm__ __volatile__(DQ_USDT_ASM_(name, "-8@%0 -8@%1")            \
+                       :                                            \
+                       : "nor"(static_cast<std::int64_t>(first)),   \
+                         "nor"(static_cast<std::int64_t>(second)))
+
+#else
+
+#define DQ_USDT_PROBE1(name, first) static_cast<void>(0)
+#define DQ_USDT_PROBE2(name, first, second) static_cast<void>(0)
+
+#endif
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace dq
+{
+
+namespace internal
+{
+
+// Futex-backed parking spot shared by every waiter of one kind on a queue.
+// Waiters register before their final re-check and publishers only pay for a
+// notify when somebody is actually parked
+class parking_lot
+{
+ public:
+  template <typename Predicate>
+  void park_until(Predicate&& ready) noexcept;
+
+  void unpark_all() noexcept;
+
+ private:
+  alignas(64) std::atomic<std::uint32_t> _epoch{0};
+  std::atomic<std::uint32_t> _parked{0};
+};
+
+template <typename Predicate>
+auto parking_lot::park_until(Predicate&& ready) noexcept -> void
+{
+  while (true)
+  {
+    const std::uint32_t epoch = _epoch.load(std::memory_order_acquire);
+
+    _parked.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (ready())
+    {
+      _parked.fetch_sub(1, std::memory_order_relaxed);
+      return;
+    }
+
+    _epoch.wait(epoch, std::memory_order_acquire);
+    _parked.fetch_sub(1, std::memory_order_relaxed);
+
+    if (ready())
+    {
+      return;
+    }
+  }
+}
+
+inline auto parking_lot::unpark_all() noexcept -> void
+{
+  // Orders the caller's publishing store before the check of _parked, pairing
+  // with the fence in park_until
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (_parked.load(std::memory_order_relaxed) == 0)
+  {
+    return;
+  }
+
+  _epoch.fetch_add(1, std::memory_order_release);
+  _epoch.notify_all();
+}
+
+}  // namespace internal
+
+// Spins until the condition holds. Never parks, so publishers never have to
+// wake anyone
+class busy_spin_wait_strategy
+{
+ public:
+  static constexpr bool needs_wakeup = false;
+
+  template <typename Predicate>
+  void wait_until(Predicate&& ready, internal::parking_lot& lot) noexcept;
+};
+
+template <typename Predicate>
+auto busy_spin_wait_strategy::wait_until(
+    Predicate&& ready, internal::parking_lot& /*lot*/) noexcept -> void
+{
+  while (!ready())
+  {
+  }
+}
+
+// Spins for a learned budget, then yields, then parks on the queue's futex.
+// The budget grows when waits finish just after spinning gives up and shrinks
+// when waits end up parked, so it tracks the observed wait length: close to
+// busy-spin latency under steady traffic, close to zero CPU when idle.
+// Each reader and writer owns its own instance, so statistics are per thread
+class adaptive_wait_strategy
+{
+ public:
+  static constexpr bool needs_wakeup = true;
+
+  static constexpr std::uint32_t MIN_SPIN_BUDGET = 64;
+  static constexpr std::uint32_t MAX_SPIN_BUDGET = 1U << 16;
+  static constexpr std::uint32_t INITIAL_SPIN_BUDGET = 1024;
+  static constexpr std::uint32_t YIELD_LIMIT = 16;
+
+  struct statistics
+  {
+    std::uint32_t spin_budget;
+    std::uint32_t average_spins;
+    std::uint64_t spin_wakeups;
+    std::uint64_t yield_wakeups;
+    std::uint64_t parks;
+  };
+
+  template <typename Predicate>
+  void wait_until(Predicate&& ready, internal::parking_lot& lot) noexcept;
+
+  // Safe to call from any thread; values are individually consistent only
+  [[nodiscard]] statistics stats() const noexcept;
+
+ private:
+  void on_spin_wakeup(std::uint32_t spins) noexcept;
+  void on_yield_wakeup() noexcept;
+  void on_park() noexcept;
+
+  static void bump(std::atomic<std::uint64_t>& counter) noexcept;
+
+  // Only the owning thread writes these
+  std::atomic<std::uint32_t> _spin_budget{INITIAL_SPIN_BUDGET};
+  std::atomic<std::uint32_t> _average_spins{0};
+  std::atomic<std::uint64_t> _spin_wakeups{0};
+  std::atomic<std::uint64_t> _yield_wakeups{0};
+  std::atomic<std::uint64_t> _parks{0};
+};
+
+template <typename Predicate>
+auto adaptive_wait_strategy::wait_until(Predicate&& ready,
+                                        internal::parking_lot& lot) noexcept
+    -> void
+{
+  // Waits that never had to wait do not count towards the statistics
+  if (ready())
+  {
+    return;
+  }
+
+  const std::uint32_t spin_budget =
+      _spin_budget.load(std::memory_order_relaxed);
+
+  for (std::uint32_t spins = 1; spins < spin_budget; ++spins)
+  {
+    if (ready())
+    {
+      on_spin_wakeup(spins);
+      return;
+    }
+  }
+
+  for (std::uint32_t yields = 0; yields < YIELD_LIMIT; ++yields)
+  {
+    std::this_thread::yield();
+
+    if (ready())
+    {
+      on_yield_wakeup();
+      return;
+    }
+  }
+
+  on_park();
+  lot.park_until(ready);
+}
+
+inline auto adaptive_wait_strategy::stats() const noexcept -> statistics
+{
+  return {_spin_budget.load(std::memory_order_relaxed),
+          _average_spins.load(std::memory_order_relaxed),
+          _spin_wakeups.load(std::memory_order_relaxed),
+          _yield_wakeups.load(std::memory_order_relaxed),
+          _parks.load(std::memory_order_relaxed)};
+}
+
+inline auto adaptive_wait_strategy::on_spin_wakeup(
+    const std::uint32_t spins) noexcept -> void
+{
+  bump(_spin_wakeups);
+
+  // EWMA with a weight of 1/8
+  const std::uint32_t average = _average_spins.load(std::memory_order_relaxed);
+  const std::uint32_t updated = average - average / 8 + spins / 8;
+  _average_spins.store(updated, std::memory_order_relaxed);
+
+  // Keep generous headroom over the typical wait, decaying slowly towards it
+  const std::uint32_t budget = _spin_budget.load(std::memory_order_relaxed);
+  if (budget > 8 * updated + MIN_SPIN_BUDGET)
+  {
+    _spin_budget.store(std::max(MIN_SPIN_BUDGET, budget - budget / 16),
+                       std::memory_order_relaxed);
+  }
+}
+
+inline auto adaptive_wait_strategy::on_yield_wakeup() noexcept -> void
+{
+  bump(_yield_wakeups);
+
+  const std::uint32_t budget = _spin_budget.load(std::memory_order_relaxed);
+  _spin_budget.store(std::min(MAX_SPIN_BUDGET, budget * 2),
+                     std::memory_order_relaxed);
+}
+
+inline auto adaptive_wait_strategy::on_park() noexcept -> void
+{
+  bump(_parks);
+
+  const std::uint32_t budget = _spin_budget.load(std::memory_order_relaxed);
+  _spin_budget.store(std::max(MIN_SPIN_BUDGET, budget / 2),
+                     std::memory_order_relaxed);
+}
+
+inline auto adaptive_wait_strategy::bump(
+    std::atomic<std::uint64_t>& counter) noexcept -> void
+{
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
+
+}  // namespace dq
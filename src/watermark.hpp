@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace dq
+{
+
+enum class watermark_crossing
+{
+  above_high,
+  below_low,
+};
+
+struct watermark_event
+{
+  watermark_crossing crossing;
+  std::int64_t occupancy;
+};
+
+// High/low occupancy thresholds with hysteresis. Once occupancy reaches the
+// high watermark the monitor stays "above" until occupancy falls to the low
+// watermark. The thread that observes a crossing only flips the state, which
+// also records the occupancy, and wakes the monitor's notifier thread; the
+// notifier invokes the callback and signals the eventfd (if any).
+//
+// Deliveries are ordered: they alternate between above_high and below_low,
+// starting with above_high, and once crossings stop the last one delivered
+// matches above_high(). A crossing that is reversed before the notifier sees
+// it is delivered as neither, so a callback that pauses an upstream on
+// above_high and resumes it on below_low cannot be left paused
+class watermark_monitor
+{
+ public:
+  // Invoked on the monitor's notifier thread, one crossing at a time
+  using callback_type = std::function<void(const watermark_event&)>;
+
+  watermark_monitor() = default;
+  ~watermark_monitor();
+
+  watermark_monitor(const watermark_monitor&) = delete;
+  watermark_monitor& operator=(const watermark_monitor&) = delete;
+
+  // Setup only, at most once. low must be below high. Starts the notifier
+  void configure(std::int64_t high, std::int64_t low,
+                 callback_type on_crossing, bool signal_eventfd);
+
+  [[nodiscard]] bool enabled() const noexcept;
+  [[nodiscard]] bool above_high() const noexcept;
+  [[nodiscard]] std::int64_t high() const noexcept;
+  [[nodiscard]] std::int64_t low() const noexcept;
+
+  // Becomes readable on every crossing, -1 if not requested or unsupported
+  [[nodiscard]] int eventfd() const noexcept;
+
+  void evaluate(std::int64_t occupancy) noexcept;
+
+  // Blocks until the notifier has handled every crossing made so far
+  void flush() const noexcept;
+
+ private:
+  // The top bit is set while above the high watermark, the rest hold the
+  // occupancy that caused the last crossing
+  static constexpr std::uint64_t ABOVE_BIT = std::uint64_t{1} << 63;
+
+  static bool is_above(std::uint64_t state) noexcept;
+  static std::uint64_t make_state(bool above, std::int64_t occupancy) noexcept;
+
+  void run_notifier() noexcept;
+  void signal(watermark_crossing crossing, std::int64_t occupancy) noexcept;
+
+  bool _enabled{false};
+  std::int64_t _high{std::numeric_limits<std::int64_t>::max()};
+  std::int64_t _low{0};
+  callback_type _on_crossing{};
+  int _eventfd{-1};
+
+  alignas(64) std::atomic<std::uint64_t> _state{0};
+
+  // Crossings made and crossings the notifier has handled
+  alignas(64) std::atomic<std::uint32_t> _crossings{0};
+  std::atomic<std::uint32_t> _handled{0};
+  std::atomic<bool> _stop{false};
+  std::thread _notifier;
+};
+
+inline watermark_monitor::~watermark_monitor()
+{
+  if (_notifier.joinable())
+  {
+    _stop.store(true, std::memory_order_relaxed);
+    _crossings.fetch_add(1, std::memory_order_release);
+    _crossings.notify_one();
+    _notifier.join();
+  }
+
+#ifdef __linux__
+  if (_eventfd >= 0)
+  {
+    ::close(_eventfd);
+  }
+#endif
+}
+
+inline auto watermark_monitor::configure(const std::int64_t high,
+                                         const std::int64_t low,
+                                         callback_type on_crossing,
+                                         const bool signal_eventfd) -> void
+{
+  _enabled = true;
+  _high = high;
+  _low = low;
+  _on_crossing = std::move(on_crossing);
+
+#ifdef __linux__
+  if (signal_eventfd && _eventfd < 0)
+  {
+    _eventfd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  }
+#else
+  (void)signal_eventfd;
+#endif
+
+  if (!_notifier.joinable())
+  {
+    _notifier = std::thread([this]() { run_notifier(); });
+  }
+}
+
+inline auto watermark_monitor::enabled() const noexcept -> bool
+{
+  return _enabled;
+}
+
+inline auto watermark_monitor::above_high() const noexcept -> bool
+{
+  return is_above(_state.load(std::memory_order_relaxed));
+}
+
+inline auto watermark_monitor::high() const noexcept -> std::int64_t
+{
+  return _high;
+}
+
+inline auto watermark_monitor::low() const noexcept -> std::int64_t
+{
+  return _low;
+}
+
+inline auto watermark_monitor::eventfd() const noexcept -> int
+{
+  return _eventfd;
+}
+
+inline auto watermark_monitor::evaluate(const std::int64_t occupancy) noexcept
+    -> void
+{
+  std::uint64_t state = _state.load(std::memory_order_relaxed);
+  const bool above = is_above(state);
+
+  if ((!above && occupancy >= _high) || (above && occupancy <= _low))
+  {
+    if (_state.compare_exchange_strong(state, make_state(!above, occupancy),
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed) &&
+        _notifier.joinable())
+    {
+      _crossings.fetch_add(1, std::memory_order_release);
+      _crossings.notify_one();
+    }
+  }
+}
+
+inline auto watermark_monitor::flush() const noexcept -> void
+{
+  const std::uint32_t target = _crossings.load(std::memory_order_acquire);
+  std::uint32_t handled = _handled.load(std::memory_order_acquire);
+
+  // Counts wrap, so compare their difference
+  while (static_cast<std::int32_t>(target - handled) > 0)
+  {
+    _handled.wait(handled, std::memory_order_acquire);
+    handled = _handled.load(std::memory_order_acquire);
+  }
+}
+
+// Sees only the latest state, so it delivers a crossing when the direction
+// differs from the last one it delivered
+inline auto watermark_monitor::run_notifier() noexcept -> void
+{
+  bool delivered_above = false;
+  std::uint32_t seen = 0;
+
+  while (true)
+  {
+    _crossings.wait(seen, std::memory_order_acquire);
+    seen = _crossings.load(std::memory_order_acquire);
+
+    if (_stop.load(std::memory_order_relaxed))
+    {
+      return;
+    }
+
+    const std::uint64_t state = _state.load(std::memory_order_acquire);
+
+    if (is_above(state) != delivered_above)
+    {
+      delivered_above = is_above(state);
+      signal(delivered_above ? watermark_crossing::above_high
+                             : watermark_crossing::below_low,
+             static_cast<std::int64_t>(state & ~ABOVE_BIT));
+    }
+
+    _handled.store(seen, std::memory_order_release);
+    _handled.notify_all();
+  }
+}
+
+inline auto watermark_monitor::signal(const watermark_crossing crossing,
+                                      const std::int64_t occupancy) noexcept
+    -> void
+{
+  if (_on_crossing)
+  {
+    _on_crossing(watermark_event{crossing, occupancy});
+  }
+
+#ifdef __linux__
+  if (_eventfd >= 0)
+  {
+    const std::uint64_t increment = 1;
+    [[maybe_unused]] const auto written =
+        ::write(_eventfd, &increment, sizeof(increment));
+  }
+#endif
+}
+
+inline auto watermark_monitor::is_above(const std::uint64_t state) noexcept
+    -> bool
+{
+  return (state & ABOVE_BIT) != 0;
+}
+
+inline auto watermark_monitor::make_state(const bool above,
+                                          const std::int64_t occupancy) noexcept
+    -> std::uint64_t
+{
+  const auto clamped = static_cast<std::uint64_t>(std::max<std::int64_t>(
+      occupancy, 0));
+  return (above ? ABOVE_BIT : 0) | (clamped & ~ABOVE_BIT);
+}
+
+}  // namespace dq
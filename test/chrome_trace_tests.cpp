@@ -0,0 +1,119 @@
+#include "chrome_trace.hpp"
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "disruptor_queue.hpp"
+#include "gtest/gtest.h"
+
+namespace dq::tests
+{
+
+TEST(Chrome_Trace_Tests, Reader_Records_Batches_And_Waits)
+{
+  disruptor_queue<int, 16, busy_spin_wait_strategy, trace_instrumentation<>>
+      queue;
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 3; ++i)
+  {
+    writer.write(i);
+  }
+
+  std::thread consumer([&]() {
+    for (int i = 0; i < 5; ++i)
+    {
+      EXPECT_EQ(reader.read(), i);
+    }
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  writer.write(3);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  writer.write(4);
+  consumer.join();
+
+  const auto spans = reader.counters().trace.spans();
+  ASSERT_EQ(spans.size(), 4U);
+
+  EXPECT_EQ(spans[0].kind, trace_span_kind::batch);
+  EXPECT_EQ(spans[0].first_sequence, 0);
+  EXPECT_EQ(spans[0].last_sequence, 2);
+
+  EXPECT_EQ(spans[1].kind, trace_span_kind::wait);
+  EXPECT_EQ(spans[1].first_sequence, 3);
+  EXPECT_GT(tsc_clock::to_nanoseconds(spans[1].end_ticks -
+                                      spans[1].begin_ticks),
+            1e6);
+
+  EXPECT_EQ(spans[2].kind, trace_span_kind::batch);
+  EXPECT_EQ(spans[2].last_sequence, 3);
+  EXPECT_EQ(spans[3].kind, trace_span_kind::wait);
+}
+
+TEST(Chrome_Trace_Tests, Exports_Trace_Events)
+{
+  disruptor_queue<int, 4, busy_spin_wait_strategy, trace_instrumentation<>>
+      queue;
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 4; ++i)
+  {
+    writer.write(i);
+  }
+
+  // The fifth write waits for the reader to free a slot
+  std::thread producer([&]() { writer.write(4); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+  for (int i = 0; i < 5; ++i)
+  {
+    EXPECT_EQ(reader.read(), i);
+  }
+  producer.join();
+
+  ASSERT_EQ(writer.counters().trace.spans().size(), 1U);
+
+  chrome_trace trace;
+  trace.add_queue(queue, "ingress \"a\"");
+
+  std::ostringstream json;
+  trace.write(json);
+
+  const std::string text = json.str();
+  EXPECT_EQ(text.rfind("{\"displayTimeUnit\"", 0), 0U);
+  EXPECT_NE(text.find("\"name\":\"ingress \\\"a\\\"\""), std::string::npos);
+  EXPECT_NE(text.find("\"name\":\"writer 0\""), std::string::npos);
+  EXPECT_NE(text.find("\"name\":\"wait\",\"cat\":\"dq\",\"ph\":\"X\",\"pid\":0,"
+                      "\"tid\":0"),
+            std::string::npos);
+}
+
+TEST(Chrome_Trace_Tests, Escapes_Control_Characters_In_Names)
+{
+  disruptor_queue<int, 4, busy_spin_wait_strategy, trace_instrumentation<>>
+      queue;
+
+  static_cast<void>(queue.create_writer());
+  static_cast<void>(queue.create_reader());
+  queue.start();
+
+  chrome_trace trace;
+  trace.add_queue(queue, "a\nb\tc\x01\x1f\\");
+
+  std::ostringstream json;
+  trace.write(json);
+
+  EXPECT_NE(json.str().find("\"name\":\"a\\nb\\tc\\u0001\\u001f\\\\\""),
+            std::string::npos);
+}
+
+}  // namespace dq::tests
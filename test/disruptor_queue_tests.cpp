@@ -1,3 +1,8 @@
+#include <chrono>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
 #include "disruptor_queue.hpp"
 #include "gtest/gtest.h"
 
@@ -98,4 +103,444 @@ TEST(Disruptor_Queue_Tests, Read_to_Reference)
   EXPECT_FLOAT_EQ(read_value_one.get_c(), 10.4f);
 }
 
+TEST(Disruptor_Queue_Tests, Fail_Policy_Rejects_When_Full)
+{
+  disruptor_queue<int, 4> queue;
+
+  auto& writer = queue.create_writer(backpressure_policy::fail);
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 4; ++i)
+  {
+    EXPECT_TRUE(writer.write(i));
+  }
+
+  EXPECT_FALSE(writer.write(4));
+  EXPECT_EQ(writer.dropped_count(), 0U);
+
+  EXPECT_EQ(reader.read(), 0);
+  EXPECT_TRUE(writer.write(5));
+
+  EXPECT_EQ(reader.read(), 1);
+  EXPECT_EQ(reader.read(), 2);
+  EXPECT_EQ(reader.read(), 3);
+  EXPECT_EQ(reader.read(), 5);
+}
+
+TEST(Disruptor_Queue_Tests, Drop_Newest_Policy_Counts_Drops)
+{
+  disruptor_queue<int, 4> queue;
+
+  auto& writer = queue.create_writer(backpressure_policy::drop_newest);
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 6; ++i)
+  {
+    writer.write_emplace(i);
+  }
+
+  EXPECT_EQ(writer.dropped_count(), 2U);
+
+  for (int i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(reader.read(), i);
+  }
+
+  EXPECT_TRUE(writer.write(6));
+  EXPECT_EQ(reader.read(), 6);
+}
+
+TEST(Disruptor_Queue_Tests, Spin_Then_Park_Policy_Waits_For_Reader)
+{
+  constexpr int ITEMS = 64;
+  disruptor_queue<int, 4> queue;
+
+  auto& writer = queue.create_writer(backpressure_policy::spin_then_park);
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  std::thread consumer([&]() {
+    for (int i = 0; i < ITEMS; ++i)
+    {
+      EXPECT_EQ(reader.read(), i);
+    }
+  });
+
+  for (int i = 0; i < ITEMS; ++i)
+  {
+    EXPECT_TRUE(writer.write(i));
+  }
+
+  consumer.join();
+  EXPECT_EQ(writer.dropped_count(), 0U);
+}
+
+TEST(Disruptor_Queue_Tests, Spin_Then_Park_Writer_Is_Woken_By_Reader)
+{
+  disruptor_queue<int, 4> queue;
+
+  auto& writer = queue.create_writer(backpressure_policy::spin_then_park);
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 4; ++i)
+  {
+    writer.write(i);
+  }
+
+  // Long enough for the writer to give up spinning and yielding and park
+  std::thread producer([&]() { EXPECT_TRUE(writer.write(4)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  EXPECT_EQ(reader.read(), 0);
+  producer.join();
+
+  for (int i = 1; i < 5; ++i)
+  {
+    EXPECT_EQ(reader.read(), i);
+  }
+}
+
+TEST(Disruptor_Queue_Tests, Adaptive_Wait_Strategy_Transfers_In_Order)
+{
+  constexpr int ITEMS = 10000;
+  disruptor_queue<int, 8, adaptive_wait_strategy> queue;
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  std::thread consumer([&]() {
+    for (int i = 0; i < ITEMS; ++i)
+    {
+      EXPECT_EQ(reader.read(), i);
+    }
+  });
+
+  for (int i = 0; i < ITEMS; ++i)
+  {
+    writer.write(i);
+  }
+
+  consumer.join();
+}
+
+TEST(Disruptor_Queue_Tests, Watermark_Crossings_From_Writer_And_Reader)
+{
+  std::vector<watermark_event> events;
+  disruptor_queue<int, 8> queue;
+  queue.set_watermarks(
+      6, 2, [&](const watermark_event& event) { events.push_back(event); });
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 5; ++i)
+  {
+    writer.write(i);
+  }
+  EXPECT_FALSE(queue.watermarks().above_high());
+
+  writer.write(5);
+  EXPECT_TRUE(queue.watermarks().above_high());
+  queue.watermarks().flush();
+
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(reader.read(), i);
+  }
+  EXPECT_TRUE(queue.watermarks().above_high());
+
+  EXPECT_EQ(reader.read(), 3);
+  EXPECT_FALSE(queue.watermarks().above_high());
+  queue.watermarks().flush();
+
+  ASSERT_EQ(events.size(), 2U);
+  EXPECT_EQ(events[0].crossing, watermark_crossing::above_high);
+  EXPECT_EQ(events[0].occupancy, 6);
+  EXPECT_EQ(events[1].crossing, watermark_crossing::below_low);
+  EXPECT_EQ(events[1].occupancy, 2);
+
+  // Writer watches the high watermark again once back below the low one,
+  // refreshing at most once per high - low claims
+  int written = 6;
+  while (!queue.watermarks().above_high())
+  {
+    ASSERT_LT(written, 12);
+    writer.write(written++);
+  }
+  queue.watermarks().flush();
+
+  ASSERT_EQ(events.size(), 3U);
+  EXPECT_GE(events[2].occupancy, 6);
+  EXPECT_LT(events[2].occupancy, 6 + (6 - 2));
+}
+
+TEST(Disruptor_Queue_Tests, Writer_Watches_High_Watermark_Again_Within_A_Lap)
+{
+  constexpr int HIGH = 16;
+  constexpr int LOW = 8;
+
+  std::vector<watermark_event> events;
+  disruptor_queue<int, 64> queue;
+  queue.set_watermarks(
+      HIGH, LOW,
+      [&](const watermark_event& event) { events.push_back(event); });
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  int written = 0;
+  int read = 0;
+
+  for (int cycle = 0; cycle < 3; ++cycle)
+  {
+    while (!queue.watermarks().above_high())
+    {
+      writer.write(written++);
+    }
+    queue.watermarks().flush();
+    ASSERT_EQ(events.size(), static_cast<std::size_t>(2 * cycle + 1));
+    EXPECT_EQ(events.back().crossing, watermark_crossing::above_high);
+    EXPECT_EQ(events.back().occupancy, written - read);
+
+    // Refreshing at most once per HIGH - LOW claims, the writer sees the
+    // crossing that many events late at most
+    EXPECT_GE(written - read, HIGH) << "in cycle " << cycle;
+    EXPECT_LT(written - read, HIGH + (HIGH - LOW)) << "in cycle " << cycle;
+
+    while (queue.watermarks().above_high())
+    {
+      EXPECT_EQ(reader.read(), read++);
+    }
+    queue.watermarks().flush();
+    ASSERT_EQ(events.size(), static_cast<std::size_t>(2 * cycle + 2));
+    EXPECT_EQ(events.back().crossing, watermark_crossing::below_low);
+    EXPECT_EQ(events.back().occupancy, LOW) << "in cycle " << cycle;
+  }
+}
+
+TEST(Disruptor_Queue_Tests, Low_Watermark_Waits_For_The_Slowest_Reader)
+{
+  std::vector<watermark_event> events;
+  disruptor_queue<int, 64> queue;
+  queue.set_watermarks(
+      16, 8, [&](const watermark_event& event) { events.push_back(event); });
+
+  auto& writer = queue.create_writer();
+  auto& fast_reader = queue.create_reader();
+  auto& slow_reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 16; ++i)
+  {
+    writer.write(i);
+  }
+  EXPECT_TRUE(queue.watermarks().above_high());
+  queue.watermarks().flush();
+
+  for (int i = 0; i < 16; ++i)
+  {
+    EXPECT_EQ(fast_reader.read(), i);
+  }
+  EXPECT_TRUE(queue.watermarks().above_high());
+
+  for (int i = 0; i < 7; ++i)
+  {
+    EXPECT_EQ(slow_reader.read(), i);
+  }
+  EXPECT_TRUE(queue.watermarks().above_high());
+
+  EXPECT_EQ(slow_reader.read(), 7);
+  EXPECT_FALSE(queue.watermarks().above_high());
+  queue.watermarks().flush();
+
+  ASSERT_EQ(events.size(), 2U);
+  EXPECT_EQ(events[1].crossing, watermark_crossing::below_low);
+  EXPECT_EQ(events[1].occupancy, 8);
+}
+
+TEST(Disruptor_Queue_Tests, Statistics_Report_Cursor_And_Lag)
+{
+  disruptor_queue<int, 8> queue;
+
+  auto& writer = queue.create_writer();
+  auto& fast_reader = queue.create_reader();
+  auto& slow_reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 5; ++i)
+  {
+    writer.write(i);
+  }
+
+  for (int i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(fast_reader.read(), i);
+  }
+  EXPECT_EQ(slow_reader.read(), 0);
+
+  const queue_statistics stats = queue.statistics();
+
+  EXPECT_EQ(stats.claimed_cursor, 4);
+  EXPECT_EQ(stats.published_cursor, 4);
+  ASSERT_EQ(stats.readers.size(), 2U);
+  EXPECT_EQ(stats.readers[0].sequence, 3);
+  EXPECT_EQ(stats.readers[0].lag, 1);
+  EXPECT_EQ(stats.readers[1].sequence, 0);
+  EXPECT_EQ(stats.readers[1].lag, 4);
+  ASSERT_EQ(stats.writers.size(), 1U);
+  EXPECT_EQ(stats.writers[0].wrap_stalls, 0U);
+}
+
+TEST(Disruptor_Queue_Tests, Reader_Rates_Are_Kept_Per_Observer)
+{
+  disruptor_queue<int, 8> queue;
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  reader_rates first_observer;
+  reader_rates second_observer;
+
+  EXPECT_DOUBLE_EQ(first_observer.update(queue.statistics())[0], 0.0);
+
+  writer.write(0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(reader.read(), 0);
+
+  // The first observer has seen the reader advance, the second only now
+  // takes its first snapshot
+  const queue_statistics stats = queue.statistics();
+  EXPECT_GT(first_observer.update(stats)[0], 0.0);
+  EXPECT_DOUBLE_EQ(second_observer.update(stats)[0], 0.0);
+}
+
+TEST(Disruptor_Queue_Tests, Statistics_Count_Wrap_Stalls)
+{
+  disruptor_queue<int, 4> queue;
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 4; ++i)
+  {
+    writer.write(i);
+  }
+
+  std::thread producer([&]() { writer.write(4); });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(reader.read(), 0);
+  producer.join();
+
+  const queue_statistics stats = queue.statistics();
+  EXPECT_EQ(stats.writers[0].wrap_stalls, 1U);
+  EXPECT_EQ(stats.published_cursor, 4);
+}
+
+static_assert(std::is_empty_v<no_instrumentation::reader_counters>);
+static_assert(std::is_empty_v<no_instrumentation::writer_counters>);
+
+TEST(Disruptor_Queue_Tests, Counting_Instrumentation_Records_Batches)
+{
+  disruptor_queue<int, 8, busy_spin_wait_strategy, counting_instrumentation>
+      queue;
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 3; ++i)
+  {
+    writer.write(i);
+  }
+
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(reader.read(), i);
+  }
+
+  std::thread producer([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    writer.write(3);
+  });
+
+  EXPECT_EQ(reader.read(), 3);
+  producer.join();
+
+  const auto& counters = reader.counters();
+  EXPECT_EQ(counters.waits.load(), 1U);
+  EXPECT_GT(counters.wait_spins.load(), 0U);
+  EXPECT_EQ(counters.batches.load(), 1U);
+  EXPECT_EQ(counters.batched_events.load(), 3U);
+  EXPECT_EQ(counters.max_batch.load(), 3U);
+}
+
+TEST(Disruptor_Queue_Tests, Counting_Instrumentation_Records_Wrap_Stalls)
+{
+  disruptor_queue<int, 4, busy_spin_wait_strategy, counting_instrumentation>
+      queue;
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 4; ++i)
+  {
+    writer.write(i);
+  }
+
+  std::thread producer([&]() { writer.write(4); });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(reader.read(), 0);
+  producer.join();
+
+  EXPECT_EQ(writer.counters().wrap_stalls.load(), 1U);
+  EXPECT_GT(writer.counters().wrap_rescans.load(), 0U);
+  EXPECT_EQ(writer.counters().claim_retries.load(), 0U);
+}
+
+TEST(Disruptor_Queue_Tests, Latency_Instrumentation_Records_Per_Reader)
+{
+  disruptor_queue<int, 8, busy_spin_wait_strategy,
+                  latency_instrumentation<counting_instrumentation>>
+      queue;
+
+  auto& writer = queue.create_writer();
+  auto& first_reader = queue.create_reader();
+  auto& second_reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 4; ++i)
+  {
+    writer.write(i);
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+  for (int i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(first_reader.read(), i);
+  }
+  EXPECT_EQ(second_reader.read(), 0);
+
+  const histogram_snapshot first = first_reader.counters().latency.snapshot();
+  EXPECT_EQ(first.total_count(), 4U);
+  EXPECT_GT(tsc_clock::to_nanoseconds(first.value_at_percentile(50.0)), 4e6);
+  EXPECT_EQ(first_reader.counters().batched_events.load(), 0U);
+
+  EXPECT_EQ(second_reader.counters().latency.snapshot().total_count(), 1U);
+
+  first_reader.counters().latency.reset();
+  EXPECT_EQ(first_reader.counters().latency.snapshot().total_count(), 0U);
+}
+
 }  // namespace dq::test
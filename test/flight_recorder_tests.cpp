@@ -0,0 +1,163 @@
+#include "flight_recorder.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "disruptor_queue.hpp"
+#include "gtest/gtest.h"
+
+namespace dq::tests
+{
+
+TEST(Flight_Recorder_Tests, Log_Keeps_Last_Depth_Events)
+{
+  flight_log<4> log;
+  EXPECT_TRUE(log.entries().empty());
+
+  for (std::int64_t sequence = 0; sequence < 6; ++sequence)
+  {
+    log.record(sequence, static_cast<std::uint64_t>(sequence) * 10, 1);
+  }
+
+  const auto entries = log.entries();
+  ASSERT_EQ(entries.size(), 4U);
+  for (const flight_entry& entry : entries)
+  {
+    EXPECT_GE(entry.sequence, 2);
+    EXPECT_EQ(entry.ticks, static_cast<std::uint64_t>(entry.sequence) * 10);
+  }
+}
+
+TEST(Flight_Recorder_Tests, Records_Are_Joined_Per_Reader)
+{
+  disruptor_queue<int, 16, busy_spin_wait_strategy,
+                  flight_recorder_instrumentation<no_instrumentation, 8>>
+      queue;
+
+  auto& writer = queue.create_writer();
+  auto& first_reader = queue.create_reader();
+  auto& second_reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 12; ++i)
+  {
+    writer.write(i);
+    EXPECT_EQ(first_reader.read(), i);
+  }
+  EXPECT_EQ(second_reader.read(), 0);
+
+  const auto records = collect_flight_records(queue);
+  ASSERT_EQ(records.size(), 8U);
+  EXPECT_EQ(records.front().sequence, 4);
+  EXPECT_EQ(records.back().sequence, 11);
+
+  for (const flight_record& record : records)
+  {
+    ASSERT_EQ(record.consume_ticks.size(), 2U);
+    EXPECT_GE(record.consume_ticks[0], record.publish_ticks);
+    EXPECT_EQ(record.consume_ticks[1], flight_record::MISSING);
+  }
+
+  std::ostringstream csv;
+  write_flight_records(csv, records);
+  const std::string header =
+      "sequence,publish_ns,publish_wrap_rescans,reader0_consume_ns";
+  EXPECT_EQ(csv.str().rfind(header, 0), 0U);
+}
+
+TEST(Flight_Recorder_Tests, Wait_Spins_Are_Recorded)
+{
+  disruptor_queue<int, 16, busy_spin_wait_strategy,
+                  flight_recorder_instrumentation<>>
+      queue;
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  std::thread consumer([&]() { EXPECT_EQ(reader.read(), 7); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  writer.write(7);
+  consumer.join();
+
+  const auto records = collect_flight_records(queue);
+  ASSERT_EQ(records.size(), 1U);
+  EXPECT_GT(records.front().wait_spins[0], 0U);
+}
+
+TEST(Flight_Recorder_Tests, Writer_Wrap_Rescans_Are_Recorded)
+{
+  disruptor_queue<int, 4, busy_spin_wait_strategy,
+                  flight_recorder_instrumentation<>>
+      queue;
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  for (int i = 0; i < 4; ++i)
+  {
+    writer.write(i);
+  }
+
+  std::thread producer([&]() { writer.write(4); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_EQ(reader.read(), 0);
+  producer.join();
+
+  const auto records = collect_flight_records(queue);
+  ASSERT_EQ(records.size(), 5U);
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(records[i].publish_wrap_rescans, 0U);
+  }
+  EXPECT_GT(records[4].publish_wrap_rescans, 0U);
+}
+
+TEST(Flight_Recorder_Tests, Signal_Triggers_Dump)
+{
+  disruptor_queue<int, 16, busy_spin_wait_strategy,
+                  flight_recorder_instrumentation<>>
+      queue;
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  writer.write(1);
+  EXPECT_EQ(reader.read(), 1);
+
+  const std::string path = ::testing::TempDir() + "flight_recorder.csv";
+  std::remove(path.c_str());
+
+  std::atomic<bool> dumped{false};
+  {
+    flight_recorder_signal_trigger trigger(
+        SIGUSR1,
+        [&]() { dumped.store(dump_flight_recorder(queue, path)); },
+        std::chrono::milliseconds(1));
+
+    std::raise(SIGUSR1);
+
+    for (int i = 0; i < 1000 && !dumped.load(); ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  ASSERT_TRUE(dumped.load());
+
+  std::ifstream csv(path);
+  std::string header;
+  std::string row;
+  std::getline(csv, header);
+  std::getline(csv, row);
+  EXPECT_EQ(row.rfind("0,0,", 0), 0U);
+}
+
+}  // namespace dq::tests
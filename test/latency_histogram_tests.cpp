@@ -0,0 +1,108 @@
+#include "latency_histogram.hpp"
+
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "tsc_clock.hpp"
+
+namespace dq::tests
+{
+
+TEST(Latency_Histogram_Tests, Small_Values_Are_Exact)
+{
+  for (std::uint64_t value = 0; value < histogram_buckets::SUB_BUCKET_COUNT;
+       ++value)
+  {
+    const std::size_t index = histogram_buckets::index_of(value);
+    EXPECT_EQ(histogram_buckets::lowest_value(index), value);
+    EXPECT_EQ(histogram_buckets::highest_value(index), value);
+  }
+}
+
+TEST(Latency_Histogram_Tests, Buckets_Contain_Their_Values)
+{
+  for (const std::uint64_t value :
+       {std::uint64_t{32}, std::uint64_t{33}, std::uint64_t{63},
+        std::uint64_t{64}, std::uint64_t{65}, std::uint64_t{1000},
+        std::uint64_t{123456789}, ~std::uint64_t{0}})
+  {
+    const std::size_t index = histogram_buckets::index_of(value);
+    ASSERT_LT(index, histogram_buckets::BUCKET_COUNT);
+    EXPECT_LE(histogram_buckets::lowest_value(index), value);
+    EXPECT_GE(histogram_buckets::highest_value(index), value);
+
+    // Relative width of a bucket is at most 1 / SUB_BUCKET_COUNT
+    const auto width = histogram_buckets::highest_value(index) -
+                       histogram_buckets::lowest_value(index);
+    EXPECT_LE(width, value / histogram_buckets::SUB_BUCKET_COUNT);
+  }
+}
+
+TEST(Latency_Histogram_Tests, Percentiles)
+{
+  latency_histogram histogram;
+
+  for (std::uint64_t value = 1; value <= 100; ++value)
+  {
+    histogram.record(value);
+  }
+
+  const histogram_snapshot snapshot = histogram.snapshot();
+
+  EXPECT_EQ(snapshot.total_count(), 100U);
+  EXPECT_EQ(snapshot.min(), 1U);
+  EXPECT_EQ(snapshot.max(), 101U);
+  EXPECT_EQ(snapshot.value_at_percentile(0.0), 1U);
+  EXPECT_NEAR(static_cast<double>(snapshot.value_at_percentile(50.0)), 50.0,
+              2.0);
+  EXPECT_NEAR(static_cast<double>(snapshot.value_at_percentile(99.0)), 99.0,
+              4.0);
+  EXPECT_NEAR(snapshot.mean(), 50.5, 1.0);
+}
+
+TEST(Latency_Histogram_Tests, Reset_Hides_Earlier_Values)
+{
+  latency_histogram histogram;
+
+  histogram.record(1000);
+  histogram.reset();
+  histogram.record(10);
+
+  const histogram_snapshot snapshot = histogram.snapshot();
+
+  EXPECT_EQ(snapshot.total_count(), 1U);
+  EXPECT_EQ(snapshot.max(), 10U);
+}
+
+TEST(Latency_Histogram_Tests, Merge)
+{
+  latency_histogram first;
+  latency_histogram second;
+
+  first.record(5);
+  second.record(7);
+  second.record(7);
+
+  histogram_snapshot merged = first.snapshot();
+  merged.merge(second.snapshot());
+
+  EXPECT_EQ(merged.total_count(), 3U);
+  EXPECT_EQ(merged.counts()[7], 2U);
+}
+
+TEST(Latency_Histogram_Tests, Tsc_Calibration_Tracks_Steady_Clock)
+{
+  const tsc_calibration& calibration = tsc_clock::calibration();
+  ASSERT_GT(calibration.ticks_per_ns, 0.0);
+  EXPECT_EQ(calibration.hardware_counter, tsc_clock::hardware_counter());
+
+  const std::uint64_t start = tsc_clock::now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const double elapsed_ns = tsc_clock::to_nanoseconds(tsc_clock::now() - start);
+
+  EXPECT_GT(elapsed_ns, 15e6);
+  EXPECT_LT(elapsed_ns, 200e6);
+}
+
+}  // namespace dq::tests
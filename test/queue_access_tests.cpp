@@ -0,0 +1,91 @@
+#include "queue_access.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+#include "disruptor_queue.hpp"
+#include "gtest/gtest.h"
+#include "owned_counter.hpp"
+
+namespace dq::internal::tests
+{
+
+// The slot, writer and reader laid out with every member but the
+// instrumentation ones. With no_instrumentation the queue's own must match,
+// so that disabled instrumentation costs no space on the hot path
+struct alignas(64) uninstrumented_slot
+{
+  std::atomic<std::int64_t> value;
+};
+
+struct alignas(64) uninstrumented_writer
+{
+  void* queue;
+  std::int64_t cached_min_consumer_sequence;
+  std::int64_t refresh_distance;
+  bool awaiting_low_crossing;
+  backpressure_policy policy;
+  owned_counter dropped_count;
+  owned_counter wrap_stalls;
+};
+
+struct alignas(64) uninstrumented_reader
+{
+  void* queue;
+  std::atomic<std::int64_t> consumer_sequence;
+  const void* gating_reader;
+};
+
+using uninstrumented_queue =
+    disruptor_queue<int, 8, busy_spin_wait_strategy, no_instrumentation>;
+
+static_assert(sizeof(queue_access::slot_type<uninstrumented_queue>) ==
+              sizeof(uninstrumented_slot));
+static_assert(sizeof(uninstrumented_queue::writer) ==
+              sizeof(uninstrumented_writer));
+static_assert(sizeof(uninstrumented_queue::reader) ==
+              sizeof(uninstrumented_reader));
+
+TEST(Queue_Access_Tests, Steps_Compose_Into_A_Write_And_Read)
+{
+  disruptor_queue<int, 8> queue;
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  std::int64_t claimed = -1;
+  ASSERT_TRUE(queue_access::claim_sequence(writer, claimed));
+  EXPECT_EQ(claimed, 0);
+  queue_access::commit_sequence(writer, claimed);
+
+  const std::int64_t next = queue_access::next_read_sequence(reader);
+  EXPECT_EQ(next, 0);
+  queue_access::wait_for_data(reader, next);
+
+  EXPECT_EQ(queue_access::min_consumer_sequence(queue), -1);
+  queue_access::update_consumer_sequence(reader, next);
+  EXPECT_EQ(queue_access::min_consumer_sequence(queue), 0);
+
+  // The composed steps leave the queue as a normal write and read would
+  EXPECT_TRUE(writer.write(7));
+  EXPECT_EQ(reader.read(), 7);
+}
+
+TEST(Queue_Access_Tests, Min_Consumer_Sequence_Is_The_Slowest_Reader)
+{
+  disruptor_queue<int, 8> queue;
+  auto& writer = queue.create_writer();
+  auto& fast_reader = queue.create_reader();
+  auto& slow_reader = queue.create_reader();
+  queue.start();
+
+  writer.write(1);
+  writer.write(2);
+  static_cast<void>(fast_reader.read());
+  static_cast<void>(fast_reader.read());
+  static_cast<void>(slow_reader.read());
+
+  EXPECT_EQ(queue_access::min_consumer_sequence(queue), 0);
+}
+
+}  // namespace dq::internal::tests
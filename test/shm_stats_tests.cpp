@@ -0,0 +1,122 @@
+#include "shm_stats.hpp"
+
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "disruptor_queue.hpp"
+#include "gtest/gtest.h"
+#include "instrumentation.hpp"
+
+namespace dq::tests
+{
+
+namespace
+{
+
+std::string region_name(const char* test)
+{
+  return "/dq_stats_test_" + std::to_string(::getpid()) + "_" + test;
+}
+
+}  // namespace
+
+TEST(Shm_Stats_Tests, Publishes_Cursor_Readers_And_Counters)
+{
+  disruptor_queue<int, 8, busy_spin_wait_strategy,
+                  latency_instrumentation<counting_instrumentation>>
+      queue;
+
+  auto& writer = queue.create_writer();
+  auto& first_reader = queue.create_reader();
+  auto& second_reader = queue.create_reader();
+  queue.start();
+
+  const std::string name = region_name("publish");
+  shm_stats_publisher publisher(queue, name, std::chrono::seconds(10));
+  ASSERT_TRUE(publisher.valid());
+
+  for (int i = 0; i < 5; ++i)
+  {
+    writer.write(i);
+    EXPECT_EQ(first_reader.read(), i);
+  }
+  EXPECT_EQ(second_reader.read(), 0);
+
+  publisher.refresh();
+
+  const shm_stats_region region = shm_stats_region::open(name);
+  ASSERT_TRUE(region.valid());
+
+  const shm_stats_header& header = region.header();
+  EXPECT_EQ(header.capacity, 8U);
+  EXPECT_EQ(header.reader_count, 2U);
+  EXPECT_EQ(header.writer_count, 1U);
+  EXPECT_EQ(header.updates.load(), 2U);
+  EXPECT_EQ(header.published_cursor.load(), 4);
+
+  EXPECT_EQ(region.reader(0).sequence.load(), 4);
+  EXPECT_EQ(region.reader(1).sequence.load(), 0);
+  EXPECT_EQ(region.reader(1).lag.load(), 4);
+  EXPECT_EQ(region.histogram_snapshot_of(0).total_count(), 5U);
+  EXPECT_EQ(region.histogram_snapshot_of(1).total_count(), 1U);
+  EXPECT_EQ(region.writer(0).dropped.load(), 0U);
+}
+
+TEST(Shm_Stats_Tests, Region_Is_Removed_With_Publisher)
+{
+  disruptor_queue<int, 8> queue;
+
+  static_cast<void>(queue.create_writer());
+  static_cast<void>(queue.create_reader());
+  queue.start();
+
+  const std::string name = region_name("removed");
+  {
+    shm_stats_publisher publisher(queue, name);
+    ASSERT_TRUE(publisher.valid());
+    EXPECT_TRUE(shm_stats_region::open(name).valid());
+  }
+
+  EXPECT_FALSE(shm_stats_region::open(name).valid());
+  EXPECT_FALSE(shm_stats_region::open("/dq_stats_test_missing").valid());
+}
+
+TEST(Shm_Stats_Tests, Live_Region_Is_Not_Replaced)
+{
+  const std::string name = region_name("live");
+  const shm_stats_region first = shm_stats_region::create(name, 1, 1, 8);
+  ASSERT_TRUE(first.valid());
+  first.header().updates.store(3);
+
+  const shm_stats_region second = shm_stats_region::create(name, 2, 2, 16);
+  EXPECT_FALSE(second.valid());
+
+  const shm_stats_region opened = shm_stats_region::open(name);
+  ASSERT_TRUE(opened.valid());
+  EXPECT_EQ(opened.header().capacity, 8U);
+  EXPECT_EQ(opened.header().updates.load(), 3U);
+}
+
+TEST(Shm_Stats_Tests, Abandoned_Region_Is_Reclaimed)
+{
+  const pid_t exited = ::fork();
+  ASSERT_GE(exited, 0);
+  if (exited == 0)
+  {
+    ::_exit(0);
+  }
+  ASSERT_EQ(::waitpid(exited, nullptr, 0), exited);
+
+  const std::string name = region_name("abandoned");
+  const shm_stats_region abandoned = shm_stats_region::create(name, 1, 1, 8);
+  ASSERT_TRUE(abandoned.valid());
+  abandoned.header().publisher_pid.store(exited);
+
+  const shm_stats_region reclaimed = shm_stats_region::create(name, 1, 1, 16);
+  ASSERT_TRUE(reclaimed.valid());
+  EXPECT_EQ(shm_stats_region::open(name).header().capacity, 16U);
+}
+
+}  // namespace dq::tests
@@ -0,0 +1,62 @@
+#include "stage_latency.hpp"
+
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace dq::tests
+{
+
+namespace
+{
+
+void run_event(stage_latency_tracer<2>& tracer, const std::uint64_t event_id,
+               const std::chrono::microseconds second_stage_service)
+{
+  tracer.on_publish(event_id);
+  tracer.on_entry(0, event_id);
+  tracer.on_exit(0, event_id);
+  tracer.on_entry(1, event_id);
+  std::this_thread::sleep_for(second_stage_service);
+  tracer.on_exit(1, event_id);
+}
+
+}  // namespace
+
+TEST(Stage_Latency_Tests, Only_Sampled_Events_Are_Traced)
+{
+  stage_latency_tracer<2> tracer(4);
+
+  for (std::uint64_t event_id = 0; event_id < 16; ++event_id)
+  {
+    run_event(tracer, event_id, std::chrono::microseconds(0));
+  }
+
+  const auto report = tracer.report();
+  EXPECT_EQ(report.end_to_end.total_count(), 4U);
+  EXPECT_EQ(report.stages[0].service.total_count(), 4U);
+  EXPECT_EQ(report.stages[1].queueing.total_count(), 4U);
+}
+
+TEST(Stage_Latency_Tests, Tail_Is_Attributed_To_Slow_Stage)
+{
+  stage_latency_tracer<2> tracer(1);
+
+  for (std::uint64_t event_id = 0; event_id < 99; ++event_id)
+  {
+    run_event(tracer, event_id, std::chrono::microseconds(0));
+  }
+  run_event(tracer, 99, std::chrono::milliseconds(5));
+
+  const auto report = tracer.report(99.9);
+
+  EXPECT_EQ(report.end_to_end.total_count(), 100U);
+  EXPECT_EQ(report.tail_events, 1U);
+  EXPECT_GT(report.stages[1].tail_service_ns, 4e6);
+  EXPECT_LT(report.stages[0].tail_service_ns,
+            report.stages[1].tail_service_ns);
+  EXPECT_NE(report.to_string().find("stage 1"), std::string::npos);
+}
+
+}  // namespace dq::tests
@@ -0,0 +1,82 @@
+#include "stall_watchdog.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "disruptor_queue.hpp"
+#include "gtest/gtest.h"
+
+namespace dq::tests
+{
+
+TEST(Stall_Watchdog_Tests, Reports_Reader_Gating_Writer)
+{
+  disruptor_queue<int, 4> queue;
+
+  auto& writer = queue.create_writer();
+  auto& fast_reader = queue.create_reader();
+  auto& slow_reader = queue.create_reader();
+  queue.start();
+
+  std::mutex reports_mutex;
+  std::vector<stall_report> reports;
+
+  stall_watchdog watchdog(queue, std::chrono::milliseconds(20),
+                          [&](const stall_report& report) {
+                            std::lock_guard<std::mutex> lock(reports_mutex);
+                            reports.push_back(report);
+                          },
+                          std::chrono::milliseconds(1));
+
+  for (int i = 0; i < 4; ++i)
+  {
+    writer.write(i);
+    EXPECT_EQ(fast_reader.read(), i);
+  }
+
+  // Claims a slot the slow reader still holds
+  std::thread producer([&]() { writer.write(4); });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  {
+    std::lock_guard<std::mutex> lock(reports_mutex);
+    ASSERT_EQ(reports.size(), 1U);
+    EXPECT_EQ(reports[0].reader_index, 1U);
+    EXPECT_EQ(reports[0].reader_sequence, -1);
+    EXPECT_EQ(reports[0].lag, 4);
+    EXPECT_TRUE(reports[0].gating_writer);
+    EXPECT_GE(reports[0].stalled_for, std::chrono::milliseconds(20));
+  }
+
+  for (int i = 0; i < 5; ++i)
+  {
+    EXPECT_EQ(slow_reader.read(), i);
+  }
+  producer.join();
+  EXPECT_EQ(fast_reader.read(), 4);
+
+  EXPECT_EQ(watchdog.stalls_reported(), 1U);
+}
+
+TEST(Stall_Watchdog_Tests, Idle_Readers_Are_Not_Stalled)
+{
+  disruptor_queue<int, 4> queue;
+
+  auto& writer = queue.create_writer();
+  auto& reader = queue.create_reader();
+  queue.start();
+
+  stall_watchdog watchdog(queue, std::chrono::milliseconds(5), {},
+                          std::chrono::milliseconds(1));
+
+  writer.write(1);
+  EXPECT_EQ(reader.read(), 1);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  EXPECT_EQ(watchdog.stalls_reported(), 0U);
+}
+
+}  // namespace dq::tests
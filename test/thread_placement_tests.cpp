@@ -0,0 +1,135 @@
+#include "thread_placement.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace dq::tests
+{
+
+namespace
+{
+
+void write_file(const std::filesystem::path& path, const std::string& text)
+{
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream(path) << text << '\n';
+}
+
+// Two packages of two cores with two hardware threads each. As on Linux,
+// siblings are numbered apart: cpu0 and cpu2 share core 0 of package 0
+std::string make_fake_sysfs()
+{
+  const std::filesystem::path root =
+      std::filesystem::path(::testing::TempDir()) / "dq_fake_sysfs";
+  std::filesystem::remove_all(root);
+  write_file(root / "online", "0-7");
+
+  for (int cpu = 0; cpu < 8; ++cpu)
+  {
+    const int package = cpu / 4;
+    const int core = cpu % 2;
+    const int first_sibling = package * 4 + core;
+    const std::filesystem::path cpu_path = root / ("cpu" + std::to_string(cpu));
+
+    write_file(cpu_path / "topology" / "core_id", std::to_string(core));
+    write_file(cpu_path / "topology" / "physical_package_id",
+               std::to_string(package));
+
+    write_file(cpu_path / "cache" / "index0" / "level", "1");
+    write_file(cpu_path / "cache" / "index0" / "type", "Instruction");
+    write_file(cpu_path / "cache" / "index0" / "shared_cpu_list",
+               std::to_string(cpu));
+    write_file(cpu_path / "cache" / "index2" / "level", "2");
+    write_file(cpu_path / "cache" / "index2" / "type", "Unified");
+    write_file(cpu_path / "cache" / "index2" / "shared_cpu_list",
+               std::to_string(first_sibling) + "," +
+                   std::to_string(first_sibling + 2));
+    write_file(cpu_path / "cache" / "index3" / "level", "3");
+    write_file(cpu_path / "cache" / "index3" / "type", "Unified");
+    write_file(cpu_path / "cache" / "index3" / "shared_cpu_list",
+               std::to_string(package * 4) + "-" +
+                   std::to_string(package * 4 + 3));
+  }
+
+  return root.string();
+}
+
+}  // namespace
+
+TEST(Thread_Placement_Tests, Parse_Cpu_List)
+{
+  EXPECT_EQ(parse_cpu_list("0"), std::vector<int>({0}));
+  EXPECT_EQ(parse_cpu_list("0-3,8,10-11"),
+            std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(parse_cpu_list("4,0-1"), std::vector<int>({0, 1, 4}));
+  EXPECT_TRUE(parse_cpu_list("").empty());
+  EXPECT_TRUE(parse_cpu_list("3-1").empty());
+  EXPECT_TRUE(parse_cpu_list("0-a").empty());
+}
+
+TEST(Thread_Placement_Tests, Reads_Topology_From_Sysfs)
+{
+  const cpu_topology topology = cpu_topology::from_sysfs(make_fake_sysfs(), {});
+  ASSERT_EQ(topology.cpus().size(), 8U);
+
+  const cpu_info* const cpu = topology.find(6);
+  ASSERT_NE(cpu, nullptr);
+  EXPECT_EQ(cpu->package_id, 1);
+  EXPECT_EQ(cpu->core_id, 0);
+  EXPECT_EQ(cpu->l2_group, 4);
+  EXPECT_EQ(cpu->l3_group, 4);
+
+  const cpu_topology allowed =
+      cpu_topology::from_sysfs(make_fake_sysfs(), {1, 5});
+  ASSERT_EQ(allowed.cpus().size(), 2U);
+  EXPECT_EQ(allowed.cpus()[1].cpu, 5);
+}
+
+TEST(Thread_Placement_Tests, Plans_Follow_Policy)
+{
+  const cpu_topology topology = cpu_topology::from_sysfs(make_fake_sysfs(), {});
+
+  const placement_plan shared_l2 =
+      plan_placement(topology, 2, placement_policy::shared_l2);
+  EXPECT_EQ(shared_l2.achieved, placement_policy::shared_l2);
+  EXPECT_EQ(shared_l2.cpus, std::vector<int>({0, 2}));
+
+  const placement_plan shared_l3 =
+      plan_placement(topology, 2, placement_policy::shared_l3);
+  EXPECT_EQ(shared_l3.achieved, placement_policy::shared_l3);
+  EXPECT_EQ(shared_l3.cpus, std::vector<int>({0, 1}));
+
+  const placement_plan separate_l3 =
+      plan_placement(topology, 2, placement_policy::separate_l3);
+  EXPECT_EQ(separate_l3.achieved, placement_policy::separate_l3);
+  EXPECT_EQ(separate_l3.cpus, std::vector<int>({0, 4}));
+
+  // Three threads cannot share an L2 here, so fall back to an L3
+  const placement_plan fallback =
+      plan_placement(topology, 3, placement_policy::shared_l2);
+  EXPECT_EQ(fallback.achieved, placement_policy::shared_l3);
+  EXPECT_EQ(fallback.cpus, std::vector<int>({0, 1, 2}));
+
+  EXPECT_NE(fallback.to_string(topology).find("thread 2 -> cpu 2"),
+            std::string::npos);
+}
+
+TEST(Thread_Placement_Tests, Too_Few_Cpus_Leaves_Threads_Unpinned)
+{
+  const cpu_topology topology =
+      cpu_topology::from_sysfs(make_fake_sysfs(), {3});
+
+  const placement_plan plan =
+      plan_placement(topology, 2, placement_policy::shared_l3);
+  EXPECT_EQ(plan.achieved, placement_policy::unpinned);
+  EXPECT_EQ(plan.cpus, std::vector<int>({3, -1}));
+
+  EXPECT_EQ(parse_placement_policy("separate_l3"),
+            placement_policy::separate_l3);
+  EXPECT_FALSE(parse_placement_policy("nearby").has_value());
+}
+
+}  // namespace dq::tests
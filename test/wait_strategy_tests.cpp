@@ -0,0 +1,101 @@
+#include "wait_strategy.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace dq::tests
+{
+
+TEST(Wait_Strategy_Tests, Parking_Lot_Wakes_Parked_Thread)
+{
+  internal::parking_lot lot;
+  std::atomic<bool> ready{false};
+
+  std::thread waiter([&]() {
+    lot.park_until([&]() { return ready.load(std::memory_order_acquire); });
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ready.store(true, std::memory_order_release);
+  lot.unpark_all();
+
+  waiter.join();
+  EXPECT_TRUE(ready.load());
+}
+
+TEST(Wait_Strategy_Tests, Adaptive_Ignores_Waits_That_Never_Wait)
+{
+  internal::parking_lot lot;
+  adaptive_wait_strategy strategy;
+
+  strategy.wait_until([]() { return true; }, lot);
+
+  const auto stats = strategy.stats();
+  EXPECT_EQ(stats.spin_wakeups, 0U);
+  EXPECT_EQ(stats.yield_wakeups, 0U);
+  EXPECT_EQ(stats.parks, 0U);
+  EXPECT_EQ(stats.spin_budget, adaptive_wait_strategy::INITIAL_SPIN_BUDGET);
+}
+
+TEST(Wait_Strategy_Tests, Adaptive_Learns_Short_Waits)
+{
+  internal::parking_lot lot;
+  adaptive_wait_strategy strategy;
+
+  for (int i = 0; i < 64; ++i)
+  {
+    int countdown = 4;
+    strategy.wait_until([&]() { return --countdown == 0; }, lot);
+  }
+
+  const auto stats = strategy.stats();
+  EXPECT_EQ(stats.spin_wakeups, 64U);
+  EXPECT_EQ(stats.parks, 0U);
+  EXPECT_LT(stats.spin_budget, adaptive_wait_strategy::INITIAL_SPIN_BUDGET);
+  EXPECT_GE(stats.spin_budget, adaptive_wait_strategy::MIN_SPIN_BUDGET);
+}
+
+TEST(Wait_Strategy_Tests, Adaptive_Shrinks_Budget_When_Parking)
+{
+  internal::parking_lot lot;
+  adaptive_wait_strategy strategy;
+  std::atomic<bool> ready{false};
+
+  std::thread waiter([&]() {
+    strategy.wait_until(
+        [&]() { return ready.load(std::memory_order_acquire); }, lot);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ready.store(true, std::memory_order_release);
+  lot.unpark_all();
+  waiter.join();
+
+  const auto stats = strategy.stats();
+  EXPECT_EQ(stats.parks, 1U);
+  EXPECT_EQ(stats.spin_budget,
+            adaptive_wait_strategy::INITIAL_SPIN_BUDGET / 2);
+}
+
+TEST(Wait_Strategy_Tests, Adaptive_Grows_Budget_On_Yield_Wakeup)
+{
+  internal::parking_lot lot;
+  adaptive_wait_strategy strategy;
+
+  std::uint32_t checks = 0;
+  strategy.wait_until(
+      [&]() {
+        return ++checks > adaptive_wait_strategy::INITIAL_SPIN_BUDGET;
+      },
+      lot);
+
+  const auto stats = strategy.stats();
+  EXPECT_EQ(stats.yield_wakeups, 1U);
+  EXPECT_EQ(stats.spin_budget,
+            adaptive_wait_strategy::INITIAL_SPIN_BUDGET * 2);
+}
+
+}  // namespace dq::tests
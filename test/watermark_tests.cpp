@@ -0,0 +1,115 @@
+#include "watermark.hpp"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace dq::tests
+{
+
+TEST(Watermark_Tests, Disabled_By_Default)
+{
+  watermark_monitor monitor;
+
+  monitor.evaluate(1000000);
+
+  EXPECT_FALSE(monitor.enabled());
+  EXPECT_FALSE(monitor.above_high());
+  EXPECT_EQ(monitor.eventfd(), -1);
+}
+
+TEST(Watermark_Tests, Crossings_Have_Hysteresis)
+{
+  std::vector<watermark_event> events;
+  watermark_monitor monitor;
+  monitor.configure(
+      8, 2, [&](const watermark_event& event) { events.push_back(event); },
+      false);
+
+  monitor.evaluate(7);
+  EXPECT_FALSE(monitor.above_high());
+
+  monitor.evaluate(8);
+  monitor.evaluate(9);
+  EXPECT_TRUE(monitor.above_high());
+  monitor.flush();
+
+  // Between the watermarks nothing changes in either direction
+  monitor.evaluate(5);
+  EXPECT_TRUE(monitor.above_high());
+
+  monitor.evaluate(2);
+  EXPECT_FALSE(monitor.above_high());
+  monitor.flush();
+
+  monitor.evaluate(5);
+  EXPECT_FALSE(monitor.above_high());
+
+  ASSERT_EQ(events.size(), 2U);
+  EXPECT_EQ(events[0].crossing, watermark_crossing::above_high);
+  EXPECT_EQ(events[0].occupancy, 8);
+  EXPECT_EQ(events[1].crossing, watermark_crossing::below_low);
+  EXPECT_EQ(events[1].occupancy, 2);
+}
+
+TEST(Watermark_Tests, Concurrent_Crossings_Are_Delivered_In_Order)
+{
+  constexpr int ITERATIONS = 100000;
+
+  std::vector<watermark_crossing> crossings;
+  watermark_monitor monitor;
+  monitor.configure(
+      8, 2,
+      [&](const watermark_event& event) {
+        crossings.push_back(event.crossing);
+      },
+      false);
+
+  std::thread filler([&]() {
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+      monitor.evaluate(8);
+    }
+  });
+
+  for (int i = 0; i < ITERATIONS; ++i)
+  {
+    monitor.evaluate(2);
+  }
+  filler.join();
+  monitor.flush();
+
+  ASSERT_FALSE(crossings.empty());
+  EXPECT_EQ(crossings.front(), watermark_crossing::above_high);
+
+  for (std::size_t i = 1; i < crossings.size(); ++i)
+  {
+    ASSERT_NE(crossings[i], crossings[i - 1]) << "at delivery " << i;
+  }
+
+  EXPECT_EQ(crossings.back() == watermark_crossing::above_high,
+            monitor.above_high());
+}
+
+#ifdef __linux__
+TEST(Watermark_Tests, Eventfd_Counts_Crossings)
+{
+  watermark_monitor monitor;
+  monitor.configure(4, 1, {}, true);
+  ASSERT_GE(monitor.eventfd(), 0);
+
+  // Crossings reversed before the notifier sees them are not delivered
+  monitor.evaluate(4);
+  monitor.flush();
+  monitor.evaluate(0);
+  monitor.flush();
+
+  std::uint64_t count = 0;
+  ASSERT_EQ(::read(monitor.eventfd(), &count, sizeof(count)),
+            static_cast<ssize_t>(sizeof(count)));
+  EXPECT_EQ(count, 2U);
+}
+#endif
+
+}  // namespace dq::tests
@@ -0,0 +1,141 @@
+// Prints the live statistics a queue publishes with dq::shm_stats_publisher.
+//
+// usage: dq_stat <region name> [interval ms] [samples]
+//
+// Each rate is the change between two consecutive samples divided by the
+// time between them. The first sample has no rate; it is taken at startup as
+// the baseline for the second and is not printed
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shm_stats.hpp"
+
+namespace
+{
+
+struct sample
+{
+  std::int64_t updated_ns;
+  std::int64_t published_cursor;
+  std::vector<std::int64_t> reader_sequences;
+};
+
+sample take_sample(const dq::shm_stats_region& region)
+{
+  constexpr auto relaxed = std::memory_order_relaxed;
+  const dq::shm_stats_header& header = region.header();
+
+  sample result{header.updated_ns.load(relaxed),
+                header.published_cursor.load(relaxed),
+                {}};
+
+  for (std::size_t i = 0; i < header.reader_count; ++i)
+  {
+    result.reader_sequences.push_back(region.reader(i).sequence.load(relaxed));
+  }
+
+  return result;
+}
+
+double rate(const std::int64_t from, const std::int64_t to,
+            const std::int64_t elapsed_ns)
+{
+  return elapsed_ns > 0 ? static_cast<double>(to - from) * 1e9 /
+                              static_cast<double>(elapsed_ns)
+                        : 0.0;
+}
+
+void print(const dq::shm_stats_region& region, const sample& previous,
+           const sample& current)
+{
+  constexpr auto relaxed = std::memory_order_relaxed;
+  const dq::shm_stats_header& header = region.header();
+  const std::int64_t elapsed_ns = current.updated_ns - previous.updated_ns;
+  const double ns_per_tick = header.nanoseconds_per_tick.load(relaxed);
+
+  std::printf("pid %lld capacity %llu claimed %lld published %lld (%.0f/s)\n",
+              static_cast<long long>(header.publisher_pid.load(relaxed)),
+              static_cast<unsigned long long>(header.capacity),
+              static_cast<long long>(header.claimed_cursor.load(relaxed)),
+              static_cast<long long>(current.published_cursor),
+              rate(previous.published_cursor, current.published_cursor,
+                   elapsed_ns));
+
+  for (std::size_t i = 0; i < header.reader_count; ++i)
+  {
+    const dq::shm_reader_stats& reader = region.reader(i);
+    std::printf("  reader %zu: sequence %lld lag %lld (%.0f/s) waits %llu",
+                i, static_cast<long long>(current.reader_sequences[i]),
+                static_cast<long long>(reader.lag.load(relaxed)),
+                rate(previous.reader_sequences[i],
+                     current.reader_sequences[i], elapsed_ns),
+                static_cast<unsigned long long>(reader.waits.load(relaxed)));
+
+    const dq::histogram_snapshot latency = region.histogram_snapshot_of(i);
+    if (latency.total_count() != 0)
+    {
+      std::printf(" latency p50 %.0fns p99 %.0fns max %.0fns",
+                  static_cast<double>(latency.value_at_percentile(50.0)) *
+                      ns_per_tick,
+                  static_cast<double>(latency.value_at_percentile(99.0)) *
+                      ns_per_tick,
+                  static_cast<double>(latency.max()) * ns_per_tick);
+    }
+    std::printf("\n");
+  }
+
+  for (std::size_t i = 0; i < header.writer_count; ++i)
+  {
+    const dq::shm_writer_stats& writer = region.writer(i);
+    std::printf("  writer %zu: wrap stalls %llu dropped %llu\n", i,
+                static_cast<unsigned long long>(
+                    writer.wrap_stalls.load(relaxed)),
+                static_cast<unsigned long long>(writer.dropped.load(relaxed)));
+  }
+
+  std::fflush(stdout);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::fprintf(stderr, "usage: %s <region name> [interval ms] [samples]\n",
+                 argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const std::string name = argv[1];
+  const auto interval =
+      std::chrono::milliseconds(argc > 2 ? std::atol(argv[2]) : 1000);
+  const long samples = argc > 3 ? std::atol(argv[3]) : -1;
+
+  const dq::shm_stats_region region = dq::shm_stats_region::open(name);
+  if (!region.valid())
+  {
+    std::fprintf(stderr, "%s: no compatible statistics region named %s\n",
+                 argv[0], name.c_str());
+    return EXIT_FAILURE;
+  }
+
+  sample previous = take_sample(region);
+
+  for (long i = 0; samples < 0 || i < samples; ++i)
+  {
+    std::this_thread::sleep_for(interval);
+
+    const sample current = take_sample(region);
+    print(region, previous, current);
+    previous = current;
+  }
+
+  return EXIT_SUCCESS;
+}